@@ -9,19 +9,69 @@ CONFIG += c++11
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    benchmark.cpp \
+    bracketindex.cpp \
+    buildprofile.cpp \
+    clexer.cpp \
+    compilecache.cpp \
     compiler.cpp \
+    compilerbackend.cpp \
+    decorationmanager.cpp \
+    diagnostics.cpp \
     editor.cpp \
+    highlightworker.cpp \
+    linediff.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    outputcollector.cpp \
+    outputconsole.cpp \
+    pchcache.cpp \
+    processutil.cpp \
+    runlimits.cpp \
+    runprocess.cpp \
+    syntaxchecker.cpp \
+    tccrunner.cpp \
+    textsearch.cpp
 
 HEADERS += \
+    benchmark.h \
+    bracketindex.h \
+    buildprofile.h \
+    clexer.h \
+    compilecache.h \
     compiler.h \
+    compilerbackend.h \
+    decorationmanager.h \
+    diagnostics.h \
     editor.h \
-    mainwindow.h
+    highlightworker.h \
+    linediff.h \
+    mainwindow.h \
+    outputcollector.h \
+    outputconsole.h \
+    pchcache.h \
+    processutil.h \
+    runlimits.h \
+    runprocess.h \
+    syntaxchecker.h \
+    tccrunner.h \
+    textsearch.h
 
 FORMS += \
     mainwindow.ui
 
+# 交互运行使用伪终端（forkpty），Linux等系统上位于libutil
+unix:!macx {
+    LIBS += -lutil
+}
+
+# 可选：链接libtcc，快速运行时在内存中编译并在fork出的子进程中运行（仅Unix）
+# 构建方式：qmake CONFIG+=tinyide_libtcc
+tinyide_libtcc:unix {
+    DEFINES += TINYIDE_HAVE_LIBTCC
+    LIBS += -ltcc -ldl
+}
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
@@ -0,0 +1,297 @@
+#include "benchmark.h"
+#include "runprocess.h"
+#include <QDir>
+#include <QStringList>
+#include <QTemporaryFile>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // 已排序样本的分位数，相邻样本之间线性插值
+    double quantile(const QVector<double> &sorted, double q)
+    {
+        if (sorted.isEmpty())
+            return 0;
+        double position = q * (sorted.size() - 1);
+        int lower = int(std::floor(position));
+        int upper = qMin(lower + 1, sorted.size() - 1);
+        return sorted[lower] + (sorted[upper] - sorted[lower]) * (position - lower);
+    }
+
+    QString summaryText(const QString &label, const SampleSummary &summary)
+    {
+        return QString("%1  最小 %2  中位 %3  平均 %4  P95 %5  标准差 %6")
+            .arg(label)
+            .arg(summary.min, 0, 'f', 3)
+            .arg(summary.median, 0, 'f', 3)
+            .arg(summary.mean, 0, 'f', 3)
+            .arg(summary.p95, 0, 'f', 3)
+            .arg(summary.stddev, 0, 'f', 3);
+    }
+}
+
+SampleSummary SampleSummary::compute(const QVector<double> &samples)
+{
+    SampleSummary summary;
+    if (samples.isEmpty())
+        return summary;
+
+    QVector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    summary.min = sorted.first();
+    summary.median = quantile(sorted, 0.5);
+    summary.p95 = quantile(sorted, 0.95);
+
+    double sum = 0;
+    for (double value : sorted)
+        sum += value;
+    summary.mean = sum / sorted.size();
+
+    if (sorted.size() > 1)
+    {
+        double squares = 0;
+        for (double value : sorted)
+            squares += (value - summary.mean) * (value - summary.mean);
+        summary.stddev = std::sqrt(squares / (sorted.size() - 1));
+    }
+    return summary;
+}
+
+// 计算统计量；离群值按Tukey方法判断，样本少于4个时不判断
+void BenchmarkResult::summarize()
+{
+    QVector<double> wall;
+    QVector<double> cpu;
+    for (const RunUsage &usage : samples)
+    {
+        wall.append(usage.wallMs);
+        cpu.append((usage.userSeconds + usage.systemSeconds) * 1000.0);
+    }
+    wallMs = SampleSummary::compute(wall);
+    cpuMs = SampleSummary::compute(cpu);
+
+    outliers.clear();
+    if (wall.size() < 4)
+        return;
+
+    QVector<double> sorted = wall;
+    std::sort(sorted.begin(), sorted.end());
+    double q1 = quantile(sorted, 0.25);
+    double q3 = quantile(sorted, 0.75);
+    double fence = 1.5 * (q3 - q1);
+    for (int i = 0; i < wall.size(); ++i)
+    {
+        if (wall[i] < q1 - fence || wall[i] > q3 + fence)
+            outliers.append(i + 1);
+    }
+}
+
+QString BenchmarkResult::toString() const
+{
+    QStringList lines;
+    lines << QString("基准测试完成：%1次运行").arg(samples.size());
+    lines << summaryText("耗时(ms) ", wallMs);
+    if (!samples.isEmpty() && samples.first().hasResourceUsage)
+        lines << summaryText("CPU(ms)  ", cpuMs);
+
+    if (outliers.isEmpty())
+    {
+        lines << "没有离群值";
+    }
+    else
+    {
+        QStringList runs;
+        for (int run : outliers)
+            runs << QString::number(run);
+        lines << QString("离群值：第%1次运行，受系统中其他负载干扰，建议增加运行次数").arg(runs.join("、"));
+    }
+    return lines.join('\n');
+}
+
+QString BenchmarkResult::compareTo(const BenchmarkResult &previous) const
+{
+    double difference = wallMs.median - previous.wallMs.median;
+    double percent = previous.wallMs.median > 0 ? difference * 100.0 / previous.wallMs.median : 0;
+    QString text = QString("与上次（%1）相比中位耗时 %2%3%")
+                       .arg(previous.time.toString("HH:mm:ss"))
+                       .arg(difference >= 0 ? "+" : "")
+                       .arg(percent, 0, 'f', 1);
+
+    if (std::fabs(difference) <= qMax(wallMs.stddev, previous.wallMs.stddev))
+        text += "，在波动范围内";
+    else
+        text += difference > 0 ? "，变慢" : "，变快";
+
+    if (configuration != previous.configuration)
+        text += QString("（上次的构建配置不同：%1）").arg(previous.configuration);
+    return text;
+}
+
+Benchmark::Benchmark(QObject *parent)
+    : QObject(parent),
+      m_process(new RunProcess(this)),
+      m_wallTimer(new QTimer(this))
+{
+    m_wallTimer->setSingleShot(true);
+    connect(m_wallTimer, &QTimer::timeout, this, &Benchmark::onWallTimeExceeded);
+    // 输出不连接，由RunProcess读出后丢弃
+    connect(m_process, &RunProcess::finished, this, &Benchmark::onRunFinished);
+}
+
+Benchmark::~Benchmark()
+{
+    delete m_inputFile;
+}
+
+bool Benchmark::isSupported()
+{
+    return RunProcess::isSupported();
+}
+
+bool Benchmark::isRunning() const
+{
+    return m_running;
+}
+
+QString Benchmark::errorString() const
+{
+    return m_errorString;
+}
+
+// 标准输入写入临时文件，每次运行都从头读取同样的内容，读完即文件结束
+bool Benchmark::start(const QString &program, const QString &workingDirectory, const BenchmarkOptions &options,
+                      const RunLimits &limits)
+{
+    // 正在进行的运行由RunProcess::start结束并回收，不再报告
+    m_running = false;
+    m_wallTimer->stop();
+    if (!RunProcess::isSupported())
+    {
+        m_errorString = tr("当前平台不支持基准测试");
+        return false;
+    }
+
+    delete m_inputFile;
+    m_inputFile = new QTemporaryFile(QDir::tempPath() + "/TinyIDE_input_XXXXXX.txt");
+    if (!m_inputFile->open() || m_inputFile->write(options.input) != options.input.size() ||
+        !m_inputFile->flush())
+    {
+        m_errorString = tr("无法写入标准输入文件: ") + m_inputFile->errorString();
+        return false;
+    }
+
+    m_program = program;
+    m_workingDirectory = workingDirectory;
+    m_options = options;
+    m_options.runs = qMax(1, options.runs);
+    m_options.warmupRuns = qMax(0, options.warmupRuns);
+    m_limits = limits;
+    m_result = BenchmarkResult();
+    m_result.time = QDateTime::currentDateTime();
+    m_completed = 0;
+    m_stopRequested = false;
+    m_process->setInputFile(m_inputFile->fileName());
+    m_process->setCpuAffinity(options.cpu);
+
+    m_running = true;
+    if (!launchRun())
+    {
+        m_running = false;
+        return false;
+    }
+    return true;
+}
+
+void Benchmark::stop()
+{
+    if (!m_running)
+        return;
+
+    // 正在运行时等程序结束后报告，两次运行之间直接结束
+    m_stopRequested = true;
+    if (m_process->isRunning())
+        m_process->stop();
+    else
+        fail(tr("基准测试已被用户终止"));
+}
+
+void Benchmark::startNextRun()
+{
+    if (!m_running)
+        return;
+    if (m_stopRequested)
+    {
+        fail(tr("基准测试已被用户终止"));
+        return;
+    }
+    if (!launchRun())
+        fail(tr("第%1次运行启动失败: %2").arg(m_completed + 1).arg(m_errorString));
+}
+
+bool Benchmark::launchRun()
+{
+    m_wallTimeExceeded = false;
+    if (!m_process->start(m_program, m_workingDirectory, m_limits, false))
+    {
+        m_errorString = m_process->errorString();
+        return false;
+    }
+    if (m_limits.wallTimeSeconds > 0)
+        m_wallTimer->start(m_limits.wallTimeSeconds * 1000);
+    return true;
+}
+
+// 一次运行结束：预热运行只计数；下一次运行在事件循环中启动，不在RunProcess的信号中重入
+void Benchmark::onRunFinished(int exitCode, bool crashed, const QString &message, const RunUsage &usage)
+{
+    m_wallTimer->stop();
+    if (!m_running)
+        return;
+
+    if (m_stopRequested)
+    {
+        fail(tr("基准测试已被用户终止"));
+        return;
+    }
+    if (m_wallTimeExceeded)
+    {
+        fail(tr("第%1次运行超过时间限制（%2 s），已被终止").arg(m_completed + 1).arg(m_limits.wallTimeSeconds));
+        return;
+    }
+    if (crashed || exitCode != 0)
+    {
+        fail(tr("第%1次运行失败: %2").arg(m_completed + 1).arg(message.trimmed()));
+        return;
+    }
+
+    ++m_completed;
+    if (m_completed > m_options.warmupRuns)
+        m_result.samples.append(usage);
+
+    int total = m_options.warmupRuns + m_options.runs;
+    emit progress(m_completed, total);
+    if (m_completed < total)
+    {
+        QTimer::singleShot(0, this, &Benchmark::startNextRun);
+        return;
+    }
+
+    m_running = false;
+    m_result.summarize();
+    emit finished(true, m_result, m_result.toString());
+}
+
+void Benchmark::onWallTimeExceeded()
+{
+    m_wallTimeExceeded = true;
+    m_process->stop();
+}
+
+void Benchmark::fail(const QString &message)
+{
+    m_running = false;
+    m_wallTimer->stop();
+    emit finished(false, m_result, message);
+}
@@ -0,0 +1,100 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include "runlimits.h"
+
+class QTemporaryFile;
+class QTimer;
+class RunProcess;
+
+// 基准测试的设置
+struct BenchmarkOptions
+{
+    int runs = 10;      // 计入统计的运行次数
+    int warmupRuns = 1; // 预热次数，结果不计入统计
+    QByteArray input;   // 每次运行相同的标准输入
+    int cpu = -1;       // 绑定的CPU编号，-1表示不绑定（仅Linux）
+};
+
+// 一组样本的统计量，单位与样本相同
+struct SampleSummary
+{
+    double min = 0;
+    double median = 0;
+    double mean = 0;
+    double p95 = 0;
+    double stddev = 0; // 样本标准差
+
+    static SampleSummary compute(const QVector<double> &samples);
+};
+
+// 一次基准测试的结果
+struct BenchmarkResult
+{
+    QDateTime time;
+    QString configuration;     // 构建配置的描述，比较时提示配置不同
+    QVector<RunUsage> samples; // 计入统计的各次运行，不含预热
+    SampleSummary wallMs;      // 耗时（毫秒）
+    SampleSummary cpuMs;       // 用户态和内核态CPU时间之和（毫秒），没有资源统计时为0
+    QVector<int> outliers;     // 耗时超出四分位距1.5倍范围的运行（从1开始的序号）
+
+    void summarize();
+    QString toString() const;
+    // 与同一文件之前的结果比较中位耗时，差异不超过两次结果中较大的标准差时视为波动
+    QString compareTo(const BenchmarkResult &previous) const;
+};
+
+// 重复运行同一程序并统计耗时：每次运行经管道、使用相同的标准输入，输出丢弃；
+// 先运行预热次数，再运行计入统计的次数，任何一次失败时整个测试失败
+class Benchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Benchmark(QObject *parent = nullptr);
+    ~Benchmark() override;
+
+    static bool isSupported();
+
+    // 开始测试，正在进行的测试会先被结束；失败时返回false，原因见errorString()
+    bool start(const QString &program, const QString &workingDirectory, const BenchmarkOptions &options,
+               const RunLimits &limits);
+    bool isRunning() const;
+    QString errorString() const;
+    void stop();
+
+signals:
+    // 已完成的运行次数（含预热）和总次数
+    void progress(int completed, int total);
+    void finished(bool success, const BenchmarkResult &result, const QString &message);
+
+private slots:
+    void startNextRun();
+    void onRunFinished(int exitCode, bool crashed, const QString &message, const RunUsage &usage);
+    void onWallTimeExceeded();
+
+private:
+    bool launchRun();
+    void fail(const QString &message);
+
+    RunProcess *m_process;
+    QTimer *m_wallTimer;             // 单次运行的时间限制
+    QTemporaryFile *m_inputFile = nullptr;
+    QString m_program;
+    QString m_workingDirectory;
+    BenchmarkOptions m_options;
+    RunLimits m_limits;
+    BenchmarkResult m_result;
+    int m_completed = 0;
+    bool m_running = false;
+    bool m_stopRequested = false;
+    bool m_wallTimeExceeded = false;
+    QString m_errorString;
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,231 @@
+#include "bracketindex.h"
+#include <algorithm>
+
+// 判断字符是否为括号，返回种类和方向
+bool BracketIndex::bracketKind(QChar c, Kind *kind, bool *open)
+{
+    switch (c.unicode())
+    {
+    case '(': *kind = Paren; *open = true; return true;
+    case ')': *kind = Paren; *open = false; return true;
+    case '{': *kind = Brace; *open = true; return true;
+    case '}': *kind = Brace; *open = false; return true;
+    case '[': *kind = Square; *open = true; return true;
+    case ']': *kind = Square; *open = false; return true;
+    default: return false;
+    }
+}
+
+// 合并相邻两段的摘要
+BracketIndex::Summary BracketIndex::combine(const Summary &left, const Summary &right)
+{
+    Summary result;
+    result.sum = left.sum + right.sum;
+    result.minPrefix = qMin(left.minPrefix, left.sum + right.minPrefix);
+    result.maxSuffix = qMax(right.maxSuffix, right.sum + left.maxSuffix);
+    return result;
+}
+
+// 重置为blockCount个空块
+void BracketIndex::reset(int blockCount)
+{
+    for (int kind = 0; kind < KindCount; ++kind)
+    {
+        m_leaves[kind].clear();
+        m_leaves[kind].resize(blockCount);
+    }
+    m_treeDirty = true;
+}
+
+// 替换一段块：行数不变时逐个更新叶子，否则拼接叶子数组并在下次查询时重建树
+void BracketIndex::replaceBlocks(int first, int removed, int inserted)
+{
+    if (removed == inserted)
+    {
+        for (int i = 0; i < inserted; ++i)
+            setBlock(first + i, QString(), QVector<CLexer::Token>());
+        return;
+    }
+
+    for (int kind = 0; kind < KindCount; ++kind)
+    {
+        QVector<Summary> &leaves = m_leaves[kind];
+        int count = qMin(removed, leaves.size() - first);
+        if (first < 0 || count < 0)
+            continue;
+        leaves.remove(first, count);
+        leaves.insert(first, inserted, Summary());
+    }
+    m_treeDirty = true;
+}
+
+// 统计块内各种括号的净深度变化、最小前缀和与最大后缀和
+void BracketIndex::setBlock(int block, const QString &text, const QVector<CLexer::Token> &tokens)
+{
+    if (block < 0 || block >= blockCount())
+        return;
+
+    Summary summaries[KindCount];
+    int running[KindCount] = {0, 0, 0};
+    int minRunningBefore[KindCount] = {0, 0, 0}; // 不含整段的前缀和最小值，用于求最大后缀和
+    for (const CLexer::Token &token : tokens)
+    {
+        Kind kind;
+        bool open;
+        if (token.type != CLexer::Bracket || token.start >= text.length() ||
+            !bracketKind(text.at(token.start), &kind, &open))
+            continue;
+
+        minRunningBefore[kind] = qMin(minRunningBefore[kind], running[kind]);
+        running[kind] += open ? 1 : -1;
+        Summary &summary = summaries[kind];
+        summary.sum = running[kind];
+        summary.minPrefix = qMin(summary.minPrefix, running[kind]);
+        summary.maxSuffix = running[kind] - minRunningBefore[kind];
+    }
+
+    for (int kind = 0; kind < KindCount; ++kind)
+    {
+        Summary &leaf = m_leaves[kind][block];
+        const Summary &summary = summaries[kind];
+        if (leaf.sum == summary.sum && leaf.minPrefix == summary.minPrefix &&
+            leaf.maxSuffix == summary.maxSuffix)
+            continue;
+
+        leaf = summary;
+        if (m_treeDirty)
+            continue;
+
+        // 自底向上更新路径上的节点
+        QVector<Summary> &tree = m_tree[kind];
+        int node = m_treeSize + block;
+        tree[node] = summary;
+        for (node >>= 1; node >= 1; node >>= 1)
+            tree[node] = combine(tree[2 * node], tree[2 * node + 1]);
+    }
+}
+
+int BracketIndex::blockCount() const
+{
+    return m_leaves[0].size();
+}
+
+// 按需重建线段树，叶子数补齐到2的幂
+void BracketIndex::ensureTree() const
+{
+    if (!m_treeDirty)
+        return;
+
+    int count = blockCount();
+    m_treeSize = 1;
+    while (m_treeSize < count)
+        m_treeSize <<= 1;
+
+    for (int kind = 0; kind < KindCount; ++kind)
+    {
+        QVector<Summary> &tree = m_tree[kind];
+        tree.fill(Summary(), 2 * m_treeSize);
+        std::copy(m_leaves[kind].constBegin(), m_leaves[kind].constEnd(), tree.begin() + m_treeSize);
+        for (int node = m_treeSize - 1; node >= 1; --node)
+            tree[node] = combine(tree[2 * node], tree[2 * node + 1]);
+    }
+    m_treeDirty = false;
+}
+
+// 在节点[lo, hi)中查找下标不小于from、深度首次降到0的块；完整跳过的节点累加到depth
+int BracketIndex::forward(Kind kind, int node, int lo, int hi, int from, int &depth) const
+{
+    if (hi <= from)
+        return -1;
+
+    const Summary &summary = m_tree[kind][node];
+    if (lo >= from && depth + summary.minPrefix > 0)
+    {
+        depth += summary.sum;
+        return -1;
+    }
+    if (hi - lo == 1)
+        return lo;
+
+    int mid = (lo + hi) / 2;
+    int found = forward(kind, 2 * node, lo, mid, from, depth);
+    if (found >= 0)
+        return found;
+    return forward(kind, 2 * node + 1, mid, hi, from, depth);
+}
+
+// 在节点[lo, hi)中从右向左查找下标不大于to、深度首次降到0的块
+int BracketIndex::backward(Kind kind, int node, int lo, int hi, int to, int &depth) const
+{
+    if (lo > to)
+        return -1;
+
+    const Summary &summary = m_tree[kind][node];
+    if (hi - 1 <= to && depth - summary.maxSuffix > 0)
+    {
+        depth -= summary.sum;
+        return -1;
+    }
+    if (hi - lo == 1)
+        return lo;
+
+    int mid = (lo + hi) / 2;
+    int found = backward(kind, 2 * node + 1, mid, hi, to, depth);
+    if (found >= 0)
+        return found;
+    return backward(kind, 2 * node, lo, mid, to, depth);
+}
+
+// 向后查找匹配所在的块
+int BracketIndex::findForward(Kind kind, int fromBlock, int depth, int *depthAtBlock) const
+{
+    if (fromBlock >= blockCount() || depth <= 0)
+        return -1;
+
+    ensureTree();
+    int found = forward(kind, 1, 0, m_treeSize, qMax(fromBlock, 0), depth);
+    if (found >= 0 && depthAtBlock)
+        *depthAtBlock = depth;
+    return found;
+}
+
+// 向前查找匹配所在的块
+int BracketIndex::findBackward(Kind kind, int fromBlock, int depth, int *depthAtBlock) const
+{
+    if (fromBlock < 0 || depth <= 0)
+        return -1;
+
+    ensureTree();
+    int found = backward(kind, 1, 0, m_treeSize, qMin(fromBlock, blockCount() - 1), depth);
+    if (found >= 0 && depthAtBlock)
+        *depthAtBlock = depth;
+    return found;
+}
+
+// 块起始处的嵌套深度：[0, block)内所有块净变化之和
+int BracketIndex::depthAtBlockStart(Kind kind, int block) const
+{
+    ensureTree();
+    const QVector<Summary> &tree = m_tree[kind];
+    int depth = 0;
+    int lo = m_treeSize;
+    int hi = m_treeSize + qBound(0, block, blockCount());
+    for (; lo < hi; lo >>= 1, hi >>= 1)
+    {
+        if (lo & 1)
+            depth += tree[lo++].sum;
+        if (hi & 1)
+            depth += tree[--hi].sum;
+    }
+    return depth;
+}
+
+// 块内未闭合的左括号数，如"} else {"为1
+int BracketIndex::unclosedInBlock(Kind kind, int block) const
+{
+    if (block < 0 || block >= blockCount())
+        return 0;
+
+    const Summary &leaf = m_leaves[kind][block];
+    return leaf.sum - qMin(leaf.minPrefix, 0);
+}
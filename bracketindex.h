@@ -0,0 +1,66 @@
+#ifndef BRACKETINDEX_H
+#define BRACKETINDEX_H
+
+#include <QString>
+#include <QVector>
+#include "clexer.h"
+
+// 括号嵌套索引：以文本块为叶子的线段树，按括号种类分别维护
+// 每个块记录净深度变化、最小前缀和与最大后缀和，匹配查找为O(log n)
+class BracketIndex
+{
+public:
+    enum Kind
+    {
+        Paren,  // ()
+        Brace,  // {}
+        Square, // []
+        KindCount
+    };
+
+    // 判断字符是否为括号，返回种类和方向
+    static bool bracketKind(QChar c, Kind *kind, bool *open);
+
+    // 重置为blockCount个空块
+    void reset(int blockCount);
+    // 将[first, first + removed)替换为inserted个空块，之后由高亮器填充
+    void replaceBlocks(int first, int removed, int inserted);
+    // 根据块文本和词法单元（只统计Bracket类型）更新块的括号摘要
+    void setBlock(int block, const QString &text, const QVector<CLexer::Token> &tokens);
+    int blockCount() const;
+
+    // 从fromBlock开始向后查找第一个使深度降到0的块，depth为进入fromBlock前的深度
+    // 找到时*depthAtBlock为进入该块前的深度，未找到返回-1
+    int findForward(Kind kind, int fromBlock, int depth, int *depthAtBlock) const;
+    // 从fromBlock开始向前查找，depth为尚未匹配的右括号数
+    int findBackward(Kind kind, int fromBlock, int depth, int *depthAtBlock) const;
+
+    // 块起始处的嵌套深度，可用于代码折叠和自动缩进
+    int depthAtBlockStart(Kind kind, int block) const;
+    // 块内未闭合的左括号数，用于回车时的自动缩进
+    int unclosedInBlock(Kind kind, int block) const;
+
+private:
+    struct Summary
+    {
+        int sum = 0;
+        int minPrefix = kNoBracketMin;
+        int maxSuffix = kNoBracketMax;
+    };
+
+    // 空块的哨兵值：不会触发任何匹配
+    static const int kNoBracketMin = 1 << 28;
+    static const int kNoBracketMax = -(1 << 28);
+
+    static Summary combine(const Summary &left, const Summary &right);
+    void ensureTree() const;
+    int forward(Kind kind, int node, int lo, int hi, int from, int &depth) const;
+    int backward(Kind kind, int node, int lo, int hi, int to, int &depth) const;
+
+    QVector<Summary> m_leaves[KindCount];
+    mutable QVector<Summary> m_tree[KindCount];
+    mutable int m_treeSize = 0;
+    mutable bool m_treeDirty = true;
+};
+
+#endif // BRACKETINDEX_H
@@ -0,0 +1,85 @@
+#include "buildprofile.h"
+
+BuildProfile::Linkage BuildProfile::defaultLinkage()
+{
+#ifdef Q_OS_WIN
+    return StaticLinkage;
+#else
+    return DynamicLinkage;
+#endif
+}
+
+QString BuildProfile::optimizationName(Optimization optimization)
+{
+    switch (optimization)
+    {
+    case Debug:
+        return "调试 (-O0 -g)";
+    case Release:
+        return "发布 (-O2)";
+    case Fast:
+        return "极速 (-O3 -march=native)";
+    case ReleaseLto:
+        return "发布+LTO (-O2 -flto)";
+    default:
+        return QString();
+    }
+}
+
+QString BuildProfile::toolchainName(Toolchain toolchain)
+{
+    switch (toolchain)
+    {
+    case Gcc:
+        return "gcc";
+    case Clang:
+        return "clang";
+    case Tcc:
+        return "tcc";
+    default:
+        return QString();
+    }
+}
+
+QStringList BuildProfile::compileFlags() const
+{
+    switch (optimization)
+    {
+    case Release:
+        return QStringList() << "-O2";
+    case Fast:
+        return QStringList() << "-O3" << "-march=native";
+    case ReleaseLto:
+        return QStringList() << "-O2" << "-flto";
+    case Debug:
+    default:
+        return QStringList() << "-O0" << "-g";
+    }
+}
+
+QStringList BuildProfile::linkFlags() const
+{
+    QStringList result;
+    if (optimization == ReleaseLto)
+        result << "-flto";
+    if (linkage == StaticLinkage)
+        result << "-static";
+    return result;
+}
+
+QString BuildProfile::description() const
+{
+    return toolchainName(toolchain) + " " + optimizationName(optimization) +
+           (linkage == StaticLinkage ? "，静态链接" : "，动态链接");
+}
+
+bool BuildProfile::operator==(const BuildProfile &other) const
+{
+    return optimization == other.optimization && linkage == other.linkage &&
+           toolchain == other.toolchain;
+}
+
+bool BuildProfile::operator!=(const BuildProfile &other) const
+{
+    return !(*this == other);
+}
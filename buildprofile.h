@@ -0,0 +1,55 @@
+#ifndef BUILDPROFILE_H
+#define BUILDPROFILE_H
+
+#include <QString>
+#include <QStringList>
+
+// 构建配置：编译器、优化级别和链接方式，每个标签页各自保存一份
+struct BuildProfile
+{
+    enum Optimization
+    {
+        Debug,      // -O0 -g
+        Release,    // -O2
+        Fast,       // -O3 -march=native
+        ReleaseLto, // -O2 -flto
+        OptimizationCount
+    };
+
+    enum Linkage
+    {
+        StaticLinkage,
+        DynamicLinkage
+    };
+
+    // 编译器，对应CompilerBackend的实现
+    enum Toolchain
+    {
+        Gcc,
+        Clang,
+        Tcc,
+        ToolchainCount
+    };
+
+    // 静态链接glibc占小程序编译时间的大头，非Windows平台默认动态链接；
+    // Windows上动态链接的程序依赖MinGW运行库DLL，保持原来的静态链接
+    static Linkage defaultLinkage();
+    static QString optimizationName(Optimization optimization);
+    static QString toolchainName(Toolchain toolchain);
+
+    // GCC风格的编译参数，预处理阶段同样需要（优化级别会影响预定义宏）
+    QStringList compileFlags() const;
+    // GCC风格的链接参数
+    QStringList linkFlags() const;
+    // 用于界面显示的简短描述
+    QString description() const;
+
+    bool operator==(const BuildProfile &other) const;
+    bool operator!=(const BuildProfile &other) const;
+
+    Optimization optimization = Debug;
+    Linkage linkage = defaultLinkage();
+    Toolchain toolchain = Gcc;
+};
+
+#endif // BUILDPROFILE_H
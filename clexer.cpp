@@ -0,0 +1,347 @@
+#include "clexer.h"
+
+namespace
+{
+    // ASCII字符类别
+    enum CharClass : unsigned char
+    {
+        O, // 其他符号
+        S, // 空白
+        I, // 标识符字符（字母、下划线）
+        D, // 数字
+        P, // 小数点
+        Q, // 双引号
+        A, // 单引号
+        L, // 斜杠
+        B  // 括号 ()[]{}
+    };
+
+    const CharClass kCharClass[128] = {
+        O, O, O, O, O, O, O, O, O, S, O, S, S, S, O, O,
+        O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+        S, O, Q, O, O, O, O, A, B, B, O, O, O, O, P, L,
+        D, D, D, D, D, D, D, D, D, D, O, O, O, O, O, O,
+        O, I, I, I, I, I, I, I, I, I, I, I, I, I, I, I,
+        I, I, I, I, I, I, I, I, I, I, I, B, O, B, O, I,
+        O, I, I, I, I, I, I, I, I, I, I, I, I, I, I, I,
+        I, I, I, I, I, I, I, I, I, I, I, B, O, B, O, O,
+    };
+
+    inline CharClass charClass(ushort c)
+    {
+        return c < 128 ? kCharClass[c] : O;
+    }
+
+    inline bool isIdentChar(ushort c)
+    {
+        CharClass cls = charClass(c);
+        return cls == I || cls == D;
+    }
+
+    inline bool isAsciiLetter(ushort c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    // 比较UTF-16片段与ASCII字符串是否完全相同
+    bool equalsAscii(const QChar *data, int length, const char *word)
+    {
+        for (int i = 0; i < length; ++i)
+        {
+            if (word[i] == '\0' || data[i].unicode() != static_cast<ushort>(word[i]))
+                return false;
+        }
+        return word[length] == '\0';
+    }
+
+    // 关键字完美哈希：h = (首字符*15 + 末字符*14 + 第二个字符) % 161
+    // 参数由离线搜索得到，保证下表中的关键字两两不冲突
+    const int kKeywordTableSize = 161;
+    const int kMinKeywordLength = 2;
+    const int kMaxKeywordLength = 9;
+
+    constexpr int keywordHash(int first, int second, int last)
+    {
+        return (first * 15 + last * 14 + second) % kKeywordTableSize;
+    }
+
+    constexpr const char *const kKeywordTable[kKeywordTableSize] = {
+        "const", nullptr, nullptr, nullptr, nullptr, "default", "virtual", "static", nullptr, nullptr,
+        "signed", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, "for", nullptr, nullptr,
+        nullptr, nullptr, nullptr, "break", "union", nullptr, "register", nullptr, nullptr, nullptr,
+        nullptr, nullptr, nullptr, nullptr, "bool", "template", "new", nullptr, "sizeof", "explicit",
+        "inline", nullptr, "float", nullptr, nullptr, "unsigned", "if", nullptr, "true", nullptr,
+        nullptr, nullptr, nullptr, nullptr, "restrict", "typename", nullptr, nullptr, nullptr,
+        "signals", nullptr, "void", "slots", nullptr, nullptr, nullptr, nullptr, "auto", nullptr,
+        "typedef", nullptr, nullptr, "short", "this", nullptr, "volatile", nullptr, nullptr, nullptr,
+        nullptr, "switch", nullptr, nullptr, "while", "struct", nullptr, nullptr, nullptr, nullptr,
+        "int", nullptr, nullptr, "enum", nullptr, nullptr, nullptr, nullptr, nullptr, "case", nullptr,
+        nullptr, nullptr, "namespace", nullptr, nullptr, nullptr, "do", nullptr, nullptr, nullptr,
+        nullptr, nullptr, "continue", nullptr, "long", nullptr, "extern", "delete", nullptr, nullptr,
+        nullptr, nullptr, nullptr, nullptr, "public", nullptr, "char", "double", nullptr, nullptr,
+        nullptr, "return", nullptr, nullptr, nullptr, "protected", nullptr, nullptr, nullptr, "else",
+        nullptr, nullptr, nullptr, "false", "class", nullptr, "friend", nullptr, nullptr, "private",
+        nullptr, "goto", nullptr, "operator", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+        nullptr,
+    };
+
+    // 编译期校验：每个关键字都位于自己的哈希槽中
+    constexpr int constLength(const char *s)
+    {
+        return *s ? 1 + constLength(s + 1) : 0;
+    }
+
+    constexpr bool slotMatches(const char *word, int slot)
+    {
+        return word == nullptr ||
+               keywordHash(word[0], word[1], word[constLength(word) - 1]) == slot;
+    }
+
+    constexpr bool keywordTableValid(int slot)
+    {
+        return slot == kKeywordTableSize ||
+               (slotMatches(kKeywordTable[slot], slot) && keywordTableValid(slot + 1));
+    }
+
+    static_assert(keywordTableValid(0), "关键字完美哈希表与哈希函数不一致");
+}
+
+// 使用完美哈希表判断标识符是否为关键字：一次哈希加一次比较
+bool CLexer::isKeyword(const QChar *data, int length)
+{
+    if (length < kMinKeywordLength || length > kMaxKeywordLength)
+        return false;
+
+    ushort first = data[0].unicode();
+    ushort second = data[1].unicode();
+    ushort last = data[length - 1].unicode();
+    if (first >= 128 || second >= 128 || last >= 128)
+        return false;
+
+    const char *word = kKeywordTable[keywordHash(first, second, last)];
+    return word && equalsAscii(data, length, word);
+}
+
+// 查找块注释结束位置，返回"*/"之后的下标，未找到返回-1
+int CLexer::findCommentEnd(const QChar *data, int length, int from)
+{
+    for (int i = from; i + 1 < length; ++i)
+    {
+        if (data[i] == QLatin1Char('*') && data[i + 1] == QLatin1Char('/'))
+            return i + 2;
+    }
+    return -1;
+}
+
+// 扫描字符串/字符常量的内容（处理转义），返回结束位置；未闭合时到行末
+int CLexer::scanQuoted(const QChar *data, int length, int from, QChar quote, bool *closed)
+{
+    int i = from;
+    while (i < length)
+    {
+        QChar c = data[i];
+        if (c == QLatin1Char('\\'))
+        {
+            i += 2;
+        }
+        else if (c == quote)
+        {
+            *closed = true;
+            return i + 1;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    *closed = false;
+    return length;
+}
+
+// 扫描数字常量：整数、十六进制、小数、指数及后缀
+int CLexer::scanNumber(const QChar *data, int length, int from)
+{
+    int i = from;
+    while (i < length)
+    {
+        ushort c = data[i].unicode();
+        if (isIdentChar(c) || c == '.')
+        {
+            ++i;
+            // 指数部分的正负号
+            if ((c == 'e' || c == 'E' || c == 'p' || c == 'P') && i < length &&
+                (data[i] == QLatin1Char('+') || data[i] == QLatin1Char('-')))
+                ++i;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+// 对一行文本单遍分词，返回行末状态
+int CLexer::tokenize(const QString &text, int state, QVector<Token> &tokens)
+{
+    tokens.clear();
+    const QChar *data = text.constData();
+    const int length = text.length();
+    int i = 0;
+
+    // 行末反斜杠表示续行（字符串或预处理指令延续到下一行）
+    const bool continued = length > 0 && data[length - 1] == QLatin1Char('\\');
+    bool preprocessor = (state & InPreprocessor) != 0;
+    bool includeDirective = false;
+
+    // 上一行未闭合的块注释
+    if (state & InComment)
+    {
+        int end = findCommentEnd(data, length, 0);
+        if (end < 0)
+        {
+            if (length > 0)
+                tokens.append({0, length, BlockComment});
+            return InComment | (preprocessor ? InPreprocessor : Normal);
+        }
+        tokens.append({0, end, BlockComment});
+        i = end;
+    }
+    // 上一行以反斜杠续行的字符串
+    else if (state & InString)
+    {
+        bool closed = false;
+        int end = scanQuoted(data, length, 0, QLatin1Char('"'), &closed);
+        if (length > 0)
+            tokens.append({0, end, String});
+        if (!closed)
+            return continued ? (InString | (preprocessor ? InPreprocessor : Normal)) : Normal;
+        i = end;
+    }
+    // 行首的预处理指令：#与指令名作为一个词法单元
+    else if (!preprocessor)
+    {
+        int j = 0;
+        while (j < length && charClass(data[j].unicode()) == S)
+            ++j;
+        if (j < length && data[j] == QLatin1Char('#'))
+        {
+            int start = j++;
+            while (j < length && charClass(data[j].unicode()) == S)
+                ++j;
+            int nameStart = j;
+            while (j < length && isIdentChar(data[j].unicode()))
+                ++j;
+            tokens.append({start, j - start, Preprocessor});
+            includeDirective = equalsAscii(data + nameStart, j - nameStart, "include");
+            preprocessor = true;
+            i = j;
+        }
+    }
+
+    while (i < length)
+    {
+        ushort c = data[i].unicode();
+        switch (charClass(c))
+        {
+        case I:
+        {
+            int start = i++;
+            bool lettersOnly = true;
+            while (i < length && isIdentChar(data[i].unicode()))
+            {
+                lettersOnly = lettersOnly && isAsciiLetter(data[i].unicode());
+                ++i;
+            }
+
+            int len = i - start;
+            if (isKeyword(data + start, len))
+                tokens.append({start, len, Keyword});
+            else if (i < length && data[i] == QLatin1Char('('))
+                tokens.append({start, len, Function});
+            else if (c == 'Q' && len > 1 && lettersOnly)
+                tokens.append({start, len, ClassName});
+            break;
+        }
+        case D:
+        {
+            int end = scanNumber(data, length, i);
+            tokens.append({i, end - i, Number});
+            i = end;
+            break;
+        }
+        case P:
+        {
+            if (i + 1 < length && charClass(data[i + 1].unicode()) == D)
+            {
+                int end = scanNumber(data, length, i);
+                tokens.append({i, end - i, Number});
+                i = end;
+            }
+            else
+            {
+                ++i;
+            }
+            break;
+        }
+        case Q:
+        case A:
+        {
+            bool closed = false;
+            int end = scanQuoted(data, length, i + 1, data[i], &closed);
+            tokens.append({i, end - i, c == '"' ? String : Char});
+            if (!closed && c == '"' && continued)
+                return InString | (preprocessor ? InPreprocessor : Normal);
+            i = end;
+            break;
+        }
+        case L:
+        {
+            if (i + 1 < length && data[i + 1] == QLatin1Char('/'))
+            {
+                tokens.append({i, length - i, LineComment});
+                return preprocessor && continued ? InPreprocessor : Normal;
+            }
+            if (i + 1 < length && data[i + 1] == QLatin1Char('*'))
+            {
+                int end = findCommentEnd(data, length, i + 2);
+                if (end < 0)
+                {
+                    tokens.append({i, length - i, BlockComment});
+                    return InComment | (preprocessor ? InPreprocessor : Normal);
+                }
+                tokens.append({i, end - i, BlockComment});
+                i = end;
+                break;
+            }
+            ++i;
+            break;
+        }
+        case B:
+        {
+            // 括号单独成为词法单元，供括号索引使用（字符串和注释中的括号不会到达这里）
+            tokens.append({i, 1, Bracket});
+            ++i;
+            break;
+        }
+        default:
+        {
+            // #include <...> 中的头文件名按字符串显示
+            if (includeDirective && c == '<')
+            {
+                int end = i + 1;
+                while (end < length && data[end] != QLatin1Char('>'))
+                    ++end;
+                end = qMin(end + 1, length);
+                tokens.append({i, end - i, String});
+                i = end;
+                break;
+            }
+            ++i;
+            break;
+        }
+        }
+    }
+
+    return preprocessor && continued ? InPreprocessor : Normal;
+}
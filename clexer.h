@@ -0,0 +1,56 @@
+#ifndef CLEXER_H
+#define CLEXER_H
+
+#include <QString>
+#include <QVector>
+
+// C语言单遍词法分析器：按字符类别表驱动，逐行扫描一次完成分词
+class CLexer
+{
+public:
+    // 词法单元类型
+    enum TokenType
+    {
+        Keyword,
+        ClassName,
+        Function,
+        String,
+        Char,
+        Number,
+        LineComment,
+        BlockComment,
+        Preprocessor,
+        Bracket // 不参与着色，只用于括号匹配
+    };
+
+    // 行首/行末的词法状态（可按位组合）
+    enum State
+    {
+        Normal = 0,
+        InComment = 1,     // 未闭合的块注释
+        InString = 2,      // 以反斜杠续行的字符串
+        InPreprocessor = 4 // 以反斜杠续行的预处理指令
+    };
+
+    struct Token
+    {
+        int start;
+        int length;
+        TokenType type;
+    };
+
+    // 对一行文本分词，tokens被清空后按出现顺序填充，返回行末状态
+    static int tokenize(const QString &text, int state, QVector<Token> &tokens);
+
+    // 使用编译期生成的完美哈希表判断标识符是否为关键字
+    static bool isKeyword(const QChar *data, int length);
+
+private:
+    static int findCommentEnd(const QChar *data, int length, int from);
+    static int scanQuoted(const QChar *data, int length, int from, QChar quote, bool *closed);
+    static int scanNumber(const QChar *data, int length, int from);
+};
+
+Q_DECLARE_TYPEINFO(CLexer::Token, Q_PRIMITIVE_TYPE);
+
+#endif // CLEXER_H
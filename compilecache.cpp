@@ -0,0 +1,163 @@
+#include "compilecache.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+CompileCache::CompileCache(const QString &directory, qint64 maxBytes)
+    : m_directory(directory), m_maxBytes(maxBytes)
+{
+    if (m_directory.isEmpty())
+        m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/compile";
+    m_valid = QDir().mkpath(m_directory);
+}
+
+QString CompileCache::directory() const
+{
+    return m_directory;
+}
+
+bool CompileCache::isValid() const
+{
+    return m_valid;
+}
+
+// 计算缓存键：各部分之间以长度分隔，避免拼接产生歧义
+QString CompileCache::makeKey(const QByteArray &preprocessed, const QByteArray &compilerId,
+                              const QStringList &flags)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QByteArray flagBytes = flags.join('\n').toUtf8();
+    hash.addData(QByteArray::number(compilerId.size()) + ':' + compilerId);
+    hash.addData(QByteArray::number(flagBytes.size()) + ':' + flagBytes);
+    hash.addData(preprocessed);
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+// 编译器标识
+QByteArray CompileCache::compilerIdentity(const QString &program)
+{
+    QString path = QStandardPaths::findExecutable(program);
+    if (path.isEmpty())
+        return program.toUtf8();
+
+    QFileInfo info(path);
+    return QString("%1|%2|%3")
+        .arg(info.canonicalFilePath())
+        .arg(info.lastModified().toMSecsSinceEpoch())
+        .arg(info.size())
+        .toUtf8();
+}
+
+QString CompileCache::entryPath(const QString &key) const
+{
+#ifdef Q_OS_WIN
+    return m_directory + "/" + key + ".exe";
+#else
+    return m_directory + "/" + key;
+#endif
+}
+
+// 查找缓存：命中后更新修改时间，作为LRU的访问时间
+QString CompileCache::lookup(const QString &key) const
+{
+    if (!m_valid)
+        return QString();
+
+    QString path = entryPath(key);
+    QFile file(path);
+    if (!file.exists())
+        return QString();
+
+    if (file.open(QIODevice::ReadWrite))
+    {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        file.close();
+    }
+    return path;
+}
+
+QString CompileCache::diagnosticsPath(const QString &key) const
+{
+    return m_directory + "/" + key + ".diag";
+}
+
+void CompileCache::setDiagnostics(const QString &key, const QByteArray &diagnostics)
+{
+    if (!m_valid)
+        return;
+
+    QFile file(diagnosticsPath(key));
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        file.write(diagnostics);
+}
+
+QByteArray CompileCache::diagnostics(const QString &key) const
+{
+    QFile file(diagnosticsPath(key));
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll();
+}
+
+QString CompileCache::stagingPath(const QString &key) const
+{
+#ifdef Q_OS_WIN
+    return QString("%1/%2.%3.tmp.exe").arg(m_directory, key).arg(QCoreApplication::applicationPid());
+#else
+    return QString("%1/%2.%3.tmp").arg(m_directory, key).arg(QCoreApplication::applicationPid());
+#endif
+}
+
+// 放入缓存：同目录内重命名，已有同键条目时直接复用
+QString CompileCache::insert(const QString &key, const QString &builtPath)
+{
+    if (!m_valid)
+        return builtPath;
+
+    QString path = entryPath(key);
+    if (QFile::exists(path))
+    {
+        QFile::remove(builtPath);
+        return path;
+    }
+    if (!QFile::rename(builtPath, path))
+        return builtPath;
+
+    evict(path);
+    return path;
+}
+
+// 按修改时间从旧到新删除条目，直到总大小不超过上限（保留刚放入的条目）
+// 诊断文件不单独淘汰，随所属条目一起删除
+void CompileCache::evict(const QString &keep)
+{
+    QDir dir(m_directory);
+    QFileInfoList entries = dir.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+
+    qint64 total = 0;
+    for (const QFileInfo &entry : entries)
+        total += entry.size();
+
+    for (const QFileInfo &entry : entries)
+    {
+        if (total <= m_maxBytes)
+            break;
+        if (entry.suffix() == "diag")
+            continue;
+        if (entry.absoluteFilePath() == QFileInfo(keep).absoluteFilePath())
+            continue;
+        // 正在运行的程序在Windows上无法删除，跳过即可
+        if (QFile::remove(entry.absoluteFilePath()))
+        {
+            total -= entry.size();
+            QFileInfo diagnostics(diagnosticsPath(entry.completeBaseName()));
+            qint64 size = diagnostics.size();
+            if (QFile::remove(diagnostics.absoluteFilePath()))
+                total -= size;
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef COMPILECACHE_H
+#define COMPILECACHE_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+
+// 按内容寻址的编译缓存：以预处理后的源码、编译器标识和编译参数的哈希为键，
+// 在磁盘缓存目录中保存可执行文件，总大小超过上限时按修改时间淘汰最久未使用的条目
+class CompileCache
+{
+public:
+    // 默认缓存大小上限（字节）
+    static const qint64 kDefaultMaxBytes = 256 * 1024 * 1024;
+
+    // directory为空时使用系统缓存目录下的compile子目录
+    explicit CompileCache(const QString &directory = QString(), qint64 maxBytes = kDefaultMaxBytes);
+
+    QString directory() const;
+    bool isValid() const;
+
+    // 计算缓存键（十六进制SHA-1）
+    static QString makeKey(const QByteArray &preprocessed, const QByteArray &compilerId,
+                           const QStringList &flags);
+    // 编译器标识：可执行文件路径、修改时间和大小，编译器升级后旧缓存自动失效
+    static QByteArray compilerIdentity(const QString &program);
+
+    // 命中时返回可执行文件路径并刷新其修改时间，未命中返回空字符串
+    QString lookup(const QString &key) const;
+    // 编译器输出的临时路径，与缓存条目位于同一目录以便原子重命名
+    QString stagingPath(const QString &key) const;
+    // 将编译结果移入缓存并执行淘汰，返回缓存中的路径；失败时返回builtPath
+    QString insert(const QString &key, const QString &builtPath);
+    // 条目附带的编译诊断（编译阶段的原始错误输出），命中时重新报告；淘汰时与条目一起删除
+    void setDiagnostics(const QString &key, const QByteArray &diagnostics);
+    QByteArray diagnostics(const QString &key) const;
+
+private:
+    QString entryPath(const QString &key) const;
+    QString diagnosticsPath(const QString &key) const;
+    void evict(const QString &keep);
+
+    QString m_directory;
+    qint64 m_maxBytes;
+    bool m_valid;
+};
+
+#endif // COMPILECACHE_H
@@ -1,162 +1,494 @@
 
 #include "compiler.h"
+#include "outputcollector.h"
+#include "pchcache.h"
+#include "processutil.h"
+#include "runprocess.h"
+#include "tccrunner.h"
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
-#include <QTemporaryFile>
-#include <QTextStream>
 #include <QCoreApplication>
-#include <QRegularExpression>
-#include <QRegularExpressionMatch>
-
-// 编译器构造函数，初始化进程和状态
+#include <QTimer>
+
+// 每次写入编译器标准输入的数据量
+static const int kStdinChunkSize = 64 * 1024;
+// 工作目录名前缀和会话锁文件名
+static const char *const kScratchPrefix = "TinyIDE_";
+static const char *const kScratchLockName = "session.lock";
+
+// 预置头文件：代替原先对源码的改写（补充头文件、在main开头插入setvbuf）
+// 无缓冲设置放在构造函数中，在main之前执行，不改变用户源码的行号；
+// 只在没有伪终端可用的交互运行中由环境变量打开，其余情况保持C运行库默认的缓冲方式
+static const char *const kPreludeName = "tinyide_prelude.h";
+static const char kPreludeText[] =
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "__attribute__((constructor)) static void tinyide_unbuffer_stdout(void)\n"
+    "{\n"
+    "    if (getenv(\"TINYIDE_UNBUFFERED\"))\n"
+    "        setvbuf(stdout, NULL, _IONBF, 0);\n"
+    "}\n";
+// 与预置头文件中检查的环境变量一致
+static const char *const kUnbufferedVariable = "TINYIDE_UNBUFFERED";
+// 缓存的编译诊断的格式标记
+static const char *const kJsonDiagnosticsTag = "json";
+static const char *const kTextDiagnosticsTag = "text";
+
+// 编译器构造函数，初始化状态；编译和运行进程在每次启动时创建
 Compiler::Compiler(QObject *parent)
     : QObject(parent),
-      m_process(new QProcess(this)),    // 编译进程
-      m_runProcess(new QProcess(this)), // 运行进程
-      m_compileSuccess(false)           // 初始编译状态
+      m_process(nullptr),
+      m_runProcess(nullptr),
+      m_memoryRunner(new TccRunner(this)),
+      m_nativeRunner(new RunProcess(this)),
+      m_benchmark(new Benchmark(this)),
+      m_wallTimer(new QTimer(this)),
+      m_pch(new PchCache(QByteArray(kPreludeText), kPreludeName, QString(), this)),
+      m_output(new OutputCollector(this)),
+      m_compileSuccess(false) // 初始编译状态
 {
-    // 连接编译进程完成信号
-    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &Compiler::onProcessFinished);
+    initScratchDirectory();
+    probeDiagnosticsFormat();
+
+    // 启动时先为默认配置生成预编译头，后台语法检查和调试构建都能用上
+    m_pch->prepare(CompilerBackend::backend(BuildProfile::Gcc), BuildProfile());
+
+    connect(m_memoryRunner, &TccRunner::compileFinished, this, &Compiler::onMemoryCompileFinished);
+    connect(m_memoryRunner, &TccRunner::runStarted, this, &Compiler::runStarted);
+    connect(m_memoryRunner, &TccRunner::runOutput, this, &Compiler::onRunnerOutput);
+    connect(m_output, &OutputCollector::outputReady, this, &Compiler::runOutput);
+    // 输出缓冲区写满时暂停读取程序输出，界面跟上后恢复，输出不丢失
+    connect(m_output, &OutputCollector::backpressureChanged, this, [this](bool paused)
+            {
+        m_nativeRunner->setOutputPaused(paused);
+        m_memoryRunner->setOutputPaused(paused); });
+    connect(m_memoryRunner, &TccRunner::runFinished, this, &Compiler::onRunnerFinished);
+    connect(m_nativeRunner, &RunProcess::started, this, &Compiler::runStarted);
+    connect(m_nativeRunner, &RunProcess::outputReceived, this, &Compiler::onRunnerOutput);
+    connect(m_nativeRunner, &RunProcess::finished, this, &Compiler::onRunnerFinished);
+
+    m_wallTimer->setSingleShot(true);
+    connect(m_wallTimer, &QTimer::timeout, this, &Compiler::onWallTimeExceeded);
+
+    connect(m_benchmark, &Benchmark::progress, this, &Compiler::benchmarkProgress);
+    connect(m_benchmark, &Benchmark::finished, this, &Compiler::onBenchmarkFinished);
+}
 
-    // 连接运行进程完成信号
-    connect(m_runProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &Compiler::onRunProcessFinished);
+// 检测gcc是否支持JSON格式的诊断输出（gcc 9起），不支持时沿用文本输出；
+// 同时检测文本输出能否按字节报告列号
+void Compiler::probeDiagnosticsFormat()
+{
+    ProcessUtil::probeOptions(this, "gcc", QStringList() << "-fdiagnostics-format=json",
+                              [this](bool supported) { m_jsonDiagnostics = supported; });
+    // 文本诊断的列号按字节报告：gcc 11起默认按显示宽度（制表符展开、宽字符占两列），
+    // 更早的版本不认识这个选项，但列号本来就是字节
+    ProcessUtil::probeOptions(this, "gcc", QStringList() << DiagnosticMapper::kByteColumnsOption,
+                              [this](bool supported) { m_byteColumns = supported; });
 }
 
 // 编译器析构函数，确保进程终止
 Compiler::~Compiler()
 {
-    // 确保所有进程在析构时终止
-    if (m_process->state() != QProcess::NotRunning)
+    // 直接强制结束仍在运行的进程，SIGKILL无法被忽略，QProcess析构时的回收很快完成
+    const QList<QProcess *> processes = findChildren<QProcess *>();
+    for (QProcess *process : processes)
     {
-        m_process->kill();
-        m_process->waitForFinished();
+        process->disconnect();
+        if (process->state() != QProcess::NotRunning)
+            process->kill();
     }
-    if (m_runProcess->state() != QProcess::NotRunning)
+
+    // 清理本进程的工作目录（缓存目录中的可执行文件保留）
+    if (!m_scratchDir.isEmpty())
     {
-        m_runProcess->kill();
-        m_runProcess->waitForFinished();
+        m_scratchLock.reset();
+        QDir(m_scratchDir).removeRecursively();
     }
 }
 
-// 编译源代码：预处理、保存到临时文件、调用GCC编译
-void Compiler::compile(const QString &sourceCode)
+// 创建本次会话的工作目录：Linux上优先放在tmpfs（/dev/shm），省去落盘
+void Compiler::initScratchDirectory()
 {
-    m_compileSuccess = false; // 重置编译状态
-    m_process->close();       // 关闭之前的编译进程
+    QString root = QDir::tempPath();
+#ifdef Q_OS_LINUX
+    QFileInfo shm("/dev/shm");
+    if (shm.isDir() && shm.isWritable())
+        root = shm.absoluteFilePath();
+#endif
+    removeStaleScratchDirectories(root);
+
+    QString dir = QDir(root).absoluteFilePath(
+        QString("%1%2").arg(kScratchPrefix).arg(QCoreApplication::applicationPid()));
+    if (!QDir().mkpath(dir))
+        return;
+
+    m_scratchLock.reset(new QLockFile(QDir(dir).absoluteFilePath(kScratchLockName)));
+    m_scratchLock->tryLock(0);
+    m_scratchDir = dir;
+}
 
-    // 预处理源代码：添加必要头文件和行缓冲设置
-    QString modifiedCode = sourceCode;
+// 工作目录，创建失败时退回系统临时目录
+QString Compiler::scratchDirectory() const
+{
+    return m_scratchDir.isEmpty() ? QDir::tempPath() : m_scratchDir;
+}
 
-    // 确保包含必要头文件
-    if (!modifiedCode.contains("#include <stdio.h>"))
+// 删除崩溃的会话遗留的工作目录：锁文件的持有进程已不存在时可以获取到锁
+void Compiler::removeStaleScratchDirectories(const QString &root)
+{
+    QDir rootDir(root);
+    QStringList names = rootDir.entryList(QStringList() << QString(kScratchPrefix) + "*",
+                                          QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &name : names)
     {
-        modifiedCode.prepend("#include <stdio.h>\n");
+        QDir dir(rootDir.absoluteFilePath(name));
+        QString lockPath = dir.absoluteFilePath(kScratchLockName);
+        if (!QFile::exists(lockPath))
+            continue;
+
+        QLockFile lock(lockPath);
+        if (lock.tryLock(0))
+        {
+            lock.unlock();
+            dir.removeRecursively();
+        }
     }
-    if (!modifiedCode.contains("#include <stdlib.h>"))
+}
+
+// 引用预置头文件的编译参数（绝对路径），供语法检查等其他gcc调用使用
+QStringList Compiler::preludeArguments()
+{
+    QStringList arguments;
+    if (m_pch->isValid())
+        arguments << "-include" << m_pch->headerPath();
+    else if (writePrelude())
+        arguments << "-include" << QDir(scratchDirectory()).absoluteFilePath(kPreludeName);
+    return arguments;
+}
+
+// 在工作目录中写入预置头文件，内容相同时不重写
+bool Compiler::writePrelude()
+{
+    QFile file(QDir(scratchDirectory()).absoluteFilePath(kPreludeName));
+    const QByteArray text(kPreludeText);
+    if (file.open(QIODevice::ReadOnly) && file.readAll() == text)
+        return true;
+    file.close();
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(text) == text.size();
+}
+
+// 在工作目录中启动编译器，进程启动后把input分块写入其标准输入；不等待启动完成
+void Compiler::startCompilerProcess(const QStringList &arguments, const QByteArray &input)
+{
+    QStringList allArguments = arguments;
+    if (useJsonDiagnostics())
+        allArguments.prepend("-fdiagnostics-format=json");
+    else if (m_byteColumns && m_backend->toolchain() == BuildProfile::Gcc)
+        allArguments.prepend(DiagnosticMapper::kByteColumnsOption);
+    qDebug() << "编译命令:" << m_backend->program() << allArguments;
+
+    ProcessUtil::retire(m_process);
+    m_process = new QProcess(this);
+    m_process->setWorkingDirectory(scratchDirectory());
+    m_stdinData = input;
+    m_stdinOffset = 0;
+    m_diagnosticParser.reset();
+    m_stageText.clear();
+    m_stageErrors.clear();
+
+    connect(m_process, &QProcess::started, this, &Compiler::onCompilerStarted);
+    connect(m_process, &QProcess::errorOccurred, this, &Compiler::onCompilerError);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &Compiler::onProcessFinished);
+    // 上一块输入写入管道后继续写下一块
+    connect(m_process, &QProcess::bytesWritten, this, &Compiler::writeNextInputChunk);
+    // JSON诊断随输出到达逐条解析发布
+    if (useJsonDiagnostics())
+        connect(m_process, &QProcess::readyReadStandardError, this, &Compiler::onCompilerDiagnosticsReady);
+
+    m_process->start(m_backend->program(), allArguments);
+}
+
+// 解析新到达的JSON诊断
+void Compiler::onCompilerDiagnosticsReady()
+{
+    QByteArray data = m_process->readAllStandardError();
+    m_stageErrors += data;
+    QVector<Diagnostic> diagnostics = m_diagnosticParser.feed(data);
+    for (const Diagnostic &diagnostic : publishDiagnostics(diagnostics))
+        m_stageText += diagnostic.toString() + '\n';
+}
+
+// 把诊断位置映射回编辑器中的文件后发出
+QVector<Diagnostic> Compiler::publishDiagnostics(QVector<Diagnostic> diagnostics)
+{
+    if (diagnostics.isEmpty())
+        return diagnostics;
+
+    for (Diagnostic &diagnostic : diagnostics)
+        m_mapper.map(&diagnostic);
+    emit diagnosticsReceived(diagnostics);
+    return diagnostics;
+}
+
+// 当前编译器是否输出JSON诊断
+bool Compiler::useJsonDiagnostics() const
+{
+    return m_jsonDiagnostics && m_backend->hasJsonDiagnostics();
+}
+
+// 读取本阶段剩余的错误输出并发布诊断，返回用于显示的文本
+QString Compiler::takeStageErrors()
+{
+    if (useJsonDiagnostics())
     {
-        modifiedCode.prepend("#include <stdlib.h>\n");
+        onCompilerDiagnosticsReady();
+        QString text = m_stageText + m_mapper.mapText(m_diagnosticParser.takePlainText().trimmed());
+        m_stageText.clear();
+        return text;
     }
 
-    // 在main()函数开头插入行缓冲设置
-    QRegularExpression mainRegex(R"(int\s+main\s*\([^)]*\)\s*\{)");
-    QRegularExpressionMatch match = mainRegex.match(modifiedCode);
+    // 旧版gcc及其他编译器：从文本输出中解析诊断
+    m_stageErrors += m_process->readAllStandardError();
+    QString text = QString::fromLocal8Bit(m_stageErrors);
+    publishDiagnostics(DiagnosticMapper::parse(text));
+    return m_mapper.mapText(text);
+}
+
+// 重新报告缓存中的编译诊断：首行记录保存时的格式，与当前格式无关
+QString Compiler::replayDiagnostics(const QByteArray &cached)
+{
+    int newline = cached.indexOf('\n');
+    if (newline < 0)
+        return QString();
 
-    if (match.hasMatch())
+    QByteArray data = cached.mid(newline + 1);
+    if (cached.left(newline) == kJsonDiagnosticsTag)
     {
-        int insertPos = match.capturedEnd();
-        QString insertion = "\n    setvbuf(stdout, NULL, _IONBF, 0); // IDE: 启用行缓冲\n";
-        modifiedCode.insert(insertPos, insertion);
+        DiagnosticStreamParser parser;
+        QString text;
+        for (const Diagnostic &diagnostic : publishDiagnostics(parser.feed(data)))
+            text += diagnostic.toString() + '\n';
+        return text + m_mapper.mapText(parser.takePlainText().trimmed());
     }
+
+    QString text = QString::fromLocal8Bit(data);
+    publishDiagnostics(DiagnosticMapper::parse(text));
+    return m_mapper.mapText(text);
+}
+
+// 编译器已启动：开始写入标准输入
+void Compiler::onCompilerStarted()
+{
+    if (m_stdinData.isEmpty())
+        m_process->closeWriteChannel();
     else
-    {
-        // 处理void main()等非标准形式
-        mainRegex.setPattern(R"(void\s+main\s*\([^)]*\)\s*\{)");
-        match = mainRegex.match(modifiedCode);
-        if (match.hasMatch())
-        {
-            int insertPos = match.capturedEnd();
-            QString insertion = "\n    setvbuf(stdout, NULL, _IONBF, 0); // IDE: 启用行缓冲\n";
-            modifiedCode.insert(insertPos, insertion);
-        }
-    }
+        writeNextInputChunk();
+}
 
-    // 检查临时目录
-    QDir tempDir(QDir::tempPath());
-    if (!tempDir.exists())
-    {
-        emit compileFinished(false, "错误：临时目录不存在: " + tempDir.path());
+// 编译器启动失败时结束本次编译；运行中出错会另外收到finished信号，由阶段处理函数报告
+void Compiler::onCompilerError(QProcess::ProcessError error)
+{
+    if (error != QProcess::FailedToStart)
         return;
-    }
 
-    // 生成唯一临时文件名
-    QString tempFileName = QString("TinyIDE_%1_%2.c")
-                               .arg(QCoreApplication::applicationPid())
-                               .arg(qrand());
-    QString tempFilePath = tempDir.absoluteFilePath(tempFileName);
+    m_stage = Idle;
+    m_stdinData.clear();
+    QString message = "错误：无法启动编译器\n";
+    message += QString("请确保%1已安装并在PATH中\n").arg(m_backend->program());
+    message += "尝试的命令: " + m_backend->program() + " " + m_process->arguments().join(" ");
+    emit compileFinished(false, message);
+}
 
-    // 清理可能存在的旧文件
-    if (QFile::exists(tempFilePath))
+// 写入下一块标准输入，上一块尚未写完时等待下一次bytesWritten；全部写完后关闭写通道
+void Compiler::writeNextInputChunk()
+{
+    if (m_stdinData.isEmpty() || m_process->bytesToWrite() > 0)
+        return;
+
+    int length = qMin(kStdinChunkSize, m_stdinData.size() - m_stdinOffset);
+    m_process->write(m_stdinData.constData() + m_stdinOffset, length);
+    m_stdinOffset += length;
+
+    if (m_stdinOffset >= m_stdinData.size())
     {
-        QFile::remove(tempFilePath);
+        // 写通道在剩余数据写完后才真正关闭
+        m_process->closeWriteChannel();
+        m_stdinData.clear();
+        m_stdinOffset = 0;
     }
+}
+
+// 编译源代码：源码原样经标准输入交给所选编译器，常用头文件和无缓冲输出由预置头文件提供
+void Compiler::compile(const QString &sourceCode, const QString &fileName)
+{
+    m_compileSuccess = false; // 重置编译状态
 
-    // 创建并写入临时源文件
-    QFile file(tempFilePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    // 上一次编译尚未结束时直接取消，不等待其退出
+    if (m_stage != Idle)
     {
-        emit compileFinished(false, "错误：无法创建临时文件: " + tempFilePath);
-        return;
+        ProcessUtil::retire(m_process);
+        m_process = nullptr;
+        m_stage = Idle;
+        if (!m_stagingPath.isEmpty())
+            QFile::remove(m_stagingPath);
     }
+    m_mapper = DiagnosticMapper(fileName);
 
-    // 写入修改后的代码
-    QTextStream out(&file);
-    out << modifiedCode;
-    file.close();
-
-    // 验证文件创建
-    if (!QFile::exists(tempFilePath))
+    if (!writePrelude())
     {
-        emit compileFinished(false, "错误：临时文件创建失败: " + tempFilePath);
+        emit compileFinished(false, "错误：无法创建预置头文件: " +
+                                        QDir(scratchDirectory()).absoluteFilePath(kPreludeName));
         return;
     }
 
-    // 生成可执行文件名
-    QString execFileName = QString("TinyIDE_output_%1.exe")
-                               .arg(QCoreApplication::applicationPid());
-    m_executablePath = tempDir.absoluteFilePath(execFileName);
-
-    // 清理可能存在的旧可执行文件
-    if (QFile::exists(m_executablePath))
+    // 先只做预处理，用预处理结果计算缓存键；源码经标准输入传给gcc，不再写临时文件
+    // 编码与原先QTextStream写文件时一致，使用本地编码
+    // 预置头文件用相对名称引用，预处理结果中不含会话目录，缓存键跨会话有效
+    m_backend = CompilerBackend::backend(m_profile.toolchain);
+    m_stage = Preprocessing;
+    QStringList prelude;
+    if (m_backend->supportsPrecompiledHeaders() && m_pch->isValid())
+    {
+        // 预编译头已就绪时，预处理结果中只留下引用它的#pragma，编译阶段直接加载而不再解析头文件；
+        // 未就绪时在后台生成，本次照常展开头文件。缓存目录固定，缓存键同样跨会话有效
+        m_pch->prepare(m_backend, m_profile);
+        prelude << "-fpch-preprocess" << "-include" << m_pch->headerPath();
+    }
+    else
     {
-        QFile::remove(m_executablePath);
+        prelude << "-include" << kPreludeName;
     }
+    startCompilerProcess(m_backend->preprocessArguments(m_profile, prelude), sourceCode.toLocal8Bit());
+}
 
-    // 设置编译参数
-    QStringList arguments;
-    arguments << "-o" << m_executablePath << tempFilePath << "-static";
-    qDebug() << "编译命令: gcc" << arguments;
+void Compiler::setBuildProfile(const BuildProfile &profile)
+{
+    m_profile = profile;
+}
 
-    // 设置工作目录
-    m_process->setWorkingDirectory(tempDir.absolutePath());
+BuildProfile Compiler::buildProfile() const
+{
+    return m_profile;
+}
 
-    // 启动编译进程
-    m_process->start("gcc", arguments);
+void Compiler::setRunMode(RunMode mode)
+{
+    m_runMode = mode;
+}
 
-    // 检查进程启动
-    if (!m_process->waitForStarted(3000))
-    {
-        QString error = "错误：无法启动编译器\n";
-        error += "请确保GCC已安装并在PATH中\n";
-        error += "尝试的命令: gcc " + arguments.join(" ");
-        emit compileFinished(false, error);
+Compiler::RunMode Compiler::runMode() const
+{
+    return m_runMode;
+}
+
+void Compiler::setRunLimits(const RunLimits &limits)
+{
+    m_limits = limits;
+}
+
+RunLimits Compiler::runLimits() const
+{
+    return m_limits;
+}
+
+RunUsage Compiler::lastRunUsage() const
+{
+    return m_lastUsage;
+}
+
+bool Compiler::isInMemoryRunSupported()
+{
+    return TccRunner::isSupported();
+}
+
+// 在内存中编译运行：预置头文件内容直接拼在源码前，用#line让诊断行号与编辑器一致
+bool Compiler::runInMemory(const QString &sourceCode, const QString &fileName)
+{
+    if (!TccRunner::isSupported())
+        return false;
+
+    // 外部运行的程序先结束
+    if (m_nativeRunner->isRunning())
+        m_nativeRunner->stop();
+    m_benchmark->stop();
+    ProcessUtil::retire(m_runProcess);
+    m_runProcess = nullptr;
+
+    m_mapper = DiagnosticMapper(fileName);
+    m_activeRunner = m_memoryRunner;
+    startRunClock();
+    QByteArray source(kPreludeText);
+    source += "#line 1 \"<stdin>\"\n";
+    source += sourceCode.toLocal8Bit();
+    if (m_memoryRunner->start(source, m_limits))
+        return true;
+    m_wallTimer->stop();
+    return false;
+}
+
+// 内存编译结束
+void Compiler::onMemoryCompileFinished(bool success, const QString &diagnostics)
+{
+    QString text = m_mapper.mapText(diagnostics);
+    publishDiagnostics(DiagnosticMapper::parse(text));
+    emit compileFinished(success, QString("编译%1！（libtcc内存编译）\n%2")
+                                      .arg(success ? "成功" : "失败")
+                                      .arg(text));
+}
+
+// 内存运行和Unix上运行的输出；已被新的运行取代时不再报告
+void Compiler::onRunnerOutput(const QByteArray &data)
+{
+    if (sender() != m_activeRunner)
         return;
-    }
+    appendRunOutput(data);
+}
+
+void Compiler::onRunnerFinished(int exitCode, bool crashed, const QString &message, const RunUsage &usage)
+{
+    if (sender() != m_activeRunner)
+        return;
+    m_activeRunner = nullptr;
+    emit runFinished(!crashed && exitCode == 0 && m_limitMessage.isEmpty(), finishOutput(message, usage));
+}
+
+// 开始一次运行：重置输出收集、计时和限制状态
+void Compiler::startRunClock()
+{
+    m_output->start();
+    m_runClock.start();
+    m_limitMessage.clear();
+    if (m_limits.wallTimeSeconds > 0)
+        m_wallTimer->start(m_limits.wallTimeSeconds * 1000);
+    else
+        m_wallTimer->stop();
+}
+
+// 输出经收集器发出，累计超过上限时终止程序，避免死循环打印占满内存和磁盘
+void Compiler::appendRunOutput(const QByteArray &data)
+{
+    m_output->append(data);
+    if (m_limits.outputBytes > 0 && m_output->stats().bytes > m_limits.outputBytes)
+        abortRun(QString("程序输出超过上限（%1 MB），已被终止").arg(m_limits.outputBytes / (1024 * 1024)));
+}
+
+void Compiler::onWallTimeExceeded()
+{
+    abortRun(QString("程序运行超过时间限制（%1 s），已被终止").arg(m_limits.wallTimeSeconds));
+}
 
-    // 保存临时文件路径供后续清理
-    m_tempFilePath = tempFilePath;
+// 因超出限制终止程序，结束消息改为说明超出的限制
+void Compiler::abortRun(const QString &reason)
+{
+    if (!m_limitMessage.isEmpty())
+        return;
+    m_limitMessage = reason;
+    stopProgram();
 }
 
 // 运行编译成功的程序
@@ -179,52 +511,127 @@ void Compiler::runProgram()
         return;
     }
 
-    // 清理之前的运行进程
-    if (m_runProcess->state() != QProcess::NotRunning)
+    // 结束之前的运行，不等待其退出
+    if (m_memoryRunner->isRunning())
+        m_memoryRunner->stop();
+    m_benchmark->stop();
+    ProcessUtil::retire(m_runProcess);
+    m_runProcess = nullptr;
+    startRunClock();
+    QFileInfo exeInfo(m_executablePath);
+
+    // Unix上自行fork运行：子进程中设置资源限制，结束时取得资源使用统计；
+    // 交互模式使用伪终端（C运行库按行缓冲，提示及时显示），基准模式使用管道（全缓冲）
+    if (RunProcess::isSupported())
     {
-        m_runProcess->kill();
-        m_runProcess->waitForFinished();
+        m_activeRunner = m_nativeRunner;
+        if (!m_nativeRunner->start(m_executablePath, exeInfo.path(), m_limits, m_runMode == InteractiveRun))
+        {
+            m_activeRunner = nullptr;
+            m_wallTimer->stop();
+            m_output->finish();
+            emit runOutput("启动失败: " + m_nativeRunner->errorString());
+            emit runFinished(false, "程序启动失败");
+        }
+        return;
     }
 
-    // 重新连接输出信号
-    disconnect(m_runProcess, &QProcess::readyReadStandardOutput, 0, 0);
-    disconnect(m_runProcess, &QProcess::readyReadStandardError, 0, 0);
+    m_runProcess = new QProcess(this);
+    m_activeRunner = m_runProcess;
+    // QProcess总是读出全部可用输出，无法暂停读取：收集器写满后丢弃最旧的输出，内存占用有上限
+    m_output->setPausable(false);
 
-    // 连接标准输出
+    // 输出只复制进收集器，解码和界面更新由收集器定时合并进行
     connect(m_runProcess, &QProcess::readyReadStandardOutput, this, [this]()
-            {
-        QString output = QString::fromLocal8Bit(m_runProcess->readAllStandardOutput());
-        emit runOutput(output); });
+            { appendRunOutput(m_runProcess->readAllStandardOutput()); });
 
     // 连接错误输出
     connect(m_runProcess, &QProcess::readyReadStandardError, this, [this]()
             {
-        QString error = QString::fromLocal8Bit(m_runProcess->readAllStandardError());
-        emit runOutput("[ERROR] " + error); });
+        m_output->append("[ERROR] ");
+        appendRunOutput(m_runProcess->readAllStandardError()); });
+
+    // 启动状态由信号通知
+    connect(m_runProcess, &QProcess::started, this, &Compiler::runStarted);
+    connect(m_runProcess, &QProcess::errorOccurred, this, &Compiler::onRunProcessError);
+    connect(m_runProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &Compiler::onRunProcessFinished);
 
     // 设置工作目录
-    QFileInfo exeInfo(m_executablePath);
     m_runProcess->setWorkingDirectory(exeInfo.path());
 
+    // 没有伪终端时（Windows）由预置头文件中的构造函数关闭缓冲，保证交互提示及时显示；
+    // CPU时间和内存限制在这里不生效，只有运行时间和输出量限制
+    if (m_runMode == InteractiveRun)
+    {
+        QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+        environment.insert(kUnbufferedVariable, "1");
+        m_runProcess->setProcessEnvironment(environment);
+    }
+
     // 合并输出通道
     m_runProcess->setProcessChannelMode(QProcess::MergedChannels);
 
     // 启动程序
     m_runProcess->start(m_executablePath);
+}
 
-    // 检查启动状态
-    if (!m_runProcess->waitForStarted(1000))
+// 基准测试：与单次运行相同的检查，之前的运行先结束；输出丢弃，只报告统计结果
+void Compiler::runBenchmark(const BenchmarkOptions &options)
+{
+    if (!m_compileSuccess || !QFile::exists(m_executablePath))
     {
-        emit runOutput("启动失败: " + m_runProcess->errorString());
+        emit benchmarkFinished(false, BenchmarkResult(), "错误：请先成功编译程序");
         return;
     }
 
-    emit runStarted();
+    // 之前的运行不再报告
+    if (m_memoryRunner->isRunning())
+        m_memoryRunner->stop();
+    if (m_nativeRunner->isRunning())
+        m_nativeRunner->stop();
+    ProcessUtil::retire(m_runProcess);
+    m_runProcess = nullptr;
+    m_activeRunner = nullptr;
+    m_wallTimer->stop();
+
+    if (!m_benchmark->start(m_executablePath, QFileInfo(m_executablePath).path(), options, m_limits))
+        emit benchmarkFinished(false, BenchmarkResult(), "基准测试启动失败: " + m_benchmark->errorString());
+}
+
+// 基准测试结束，结果附上本次编译的构建配置
+void Compiler::onBenchmarkFinished(bool success, const BenchmarkResult &result, const QString &message)
+{
+    BenchmarkResult described = result;
+    described.configuration = m_profile.description();
+    emit benchmarkFinished(success, described, message);
+}
+
+// 程序启动失败
+void Compiler::onRunProcessError(QProcess::ProcessError error)
+{
+    if (error != QProcess::FailedToStart)
+        return;
+
+    m_wallTimer->stop();
+    m_output->finish();
+    emit runOutput("启动失败: " + m_runProcess->errorString());
+    emit runFinished(false, "程序启动失败");
 }
 
 // 发送输入到运行中的程序
 void Compiler::sendInput(const QString &input)
 {
+    if (m_memoryRunner->isRunning())
+    {
+        m_memoryRunner->sendInput(input.toLocal8Bit() + "\n");
+        return;
+    }
+    if (m_nativeRunner->isRunning())
+    {
+        m_nativeRunner->write(input.toLocal8Bit() + "\n");
+        return;
+    }
     if (m_runProcess && m_runProcess->state() == QProcess::Running)
     {
         m_runProcess->write(input.toLocal8Bit());
@@ -235,27 +642,99 @@ void Compiler::sendInput(const QString &input)
 // 停止运行中的程序
 void Compiler::stopProgram()
 {
+    // 内存运行、Unix上运行的程序和基准测试结束后由各自的运行器报告
+    if (m_benchmark->isRunning())
+    {
+        m_benchmark->stop();
+        return;
+    }
+    if (m_memoryRunner->isRunning())
+    {
+        m_memoryRunner->stop();
+        return;
+    }
+    if (m_nativeRunner->isRunning())
+    {
+        m_nativeRunner->stop();
+        return;
+    }
+
     // 检查运行状态
-    if (m_runProcess->state() != QProcess::NotRunning)
+    if (m_runProcess && m_runProcess->state() != QProcess::NotRunning)
     {
-        // 终止运行进程
-        m_runProcess->kill();
-        m_runProcess->waitForFinished();
+        // 终止运行进程：先请求退出，宽限期后强制结束，不等待
+        ProcessUtil::retire(m_runProcess);
+        m_runProcess = nullptr;
 
         // 发送终止信号
-        emit runFinished(false, "程序已被用户终止");
+        emit runFinished(false, finishOutput("程序已被用户终止"));
+    }
+}
+
+// 编译进程完成处理：按当前阶段分派
+void Compiler::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (m_stage == Preprocessing)
+        onPreprocessFinished(exitCode, exitStatus);
+    else if (m_stage == Compiling)
+        onCompileStageFinished(exitCode, exitStatus);
+}
+
+// 预处理完成：查询缓存，命中则直接使用缓存的可执行文件，否则编译预处理结果
+void Compiler::onPreprocessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    QByteArray preprocessed = m_process->readAllStandardOutput();
+    QString errors = takeStageErrors();
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0)
+    {
+        m_stage = Idle;
+        emit compileFinished(false, QString("编译失败！\n退出代码: %1\n%2").arg(exitCode).arg(errors));
+        return;
     }
+
+    m_cacheKey = CompileCache::makeKey(preprocessed, CompileCache::compilerIdentity(m_backend->program()),
+                                       m_backend->compileArguments(m_profile, QString()));
+    QString cached = m_cache.lookup(m_cacheKey);
+    if (!cached.isEmpty())
+    {
+        m_stage = Idle;
+        m_executablePath = cached;
+        m_compileSuccess = true;
+        // 编译阶段的警告同样重新报告，问题列表和编辑器中的标记与实际编译时一致
+        errors += replayDiagnostics(m_cache.diagnostics(m_cacheKey));
+        emit compileFinished(true, QString("编译成功！（源码与参数未变，使用编译缓存）\n%1").arg(errors));
+        return;
+    }
+
+    // 未命中：把预处理结果再经标准输入交给编译器，省去第二次预处理
+    m_stagingPath = m_cache.isValid() ? m_cache.stagingPath(m_cacheKey)
+                                      : QDir(scratchDirectory()).absoluteFilePath("output.exe");
+    QFile::remove(m_stagingPath);
+
+    m_stage = Compiling;
+    startCompilerProcess(m_backend->compileArguments(m_profile, m_stagingPath), preprocessed);
 }
 
-// 编译进程完成处理：检查结果、清理临时文件、发送信号
-void Compiler::onProcessFinished(int exitCode, QProcess::ExitStatus)
+// 编译完成：检查结果、放入缓存、发送信号
+void Compiler::onCompileStageFinished(int exitCode, QProcess::ExitStatus)
 {
+    m_stage = Idle;
+
     // 获取编译输出
-    QString output = m_process->readAllStandardOutput() +
-                     m_process->readAllStandardError();
+    QString output = m_mapper.mapText(QString::fromLocal8Bit(m_process->readAllStandardOutput())) +
+                     takeStageErrors();
 
     // 检查编译结果
-    m_compileSuccess = (exitCode == 0 && QFile::exists(m_executablePath));
+    m_compileSuccess = (exitCode == 0 && QFile::exists(m_stagingPath));
+    if (m_compileSuccess)
+    {
+        m_executablePath = m_cache.insert(m_cacheKey, m_stagingPath);
+        QByteArray format = useJsonDiagnostics() ? kJsonDiagnosticsTag : kTextDiagnosticsTag;
+        m_cache.setDiagnostics(m_cacheKey, format + '\n' + m_stageErrors);
+    }
+    else
+        QFile::remove(m_stagingPath);
 
     // 生成结果消息
     QString result = QString("编译%1！\n退出代码: %2\n%3")
@@ -263,43 +742,49 @@ void Compiler::onProcessFinished(int exitCode, QProcess::ExitStatus)
                          .arg(exitCode)
                          .arg(output);
 
-    // 清理临时源文件
-    if (!m_tempFilePath.isEmpty() && QFile::exists(m_tempFilePath))
-    {
-        QFile::remove(m_tempFilePath);
-    }
-
     // 发送编译完成信号
     emit compileFinished(m_compileSuccess, result);
 }
 
-// 运行进程完成处理：获取输出、清理可执行文件、发送信号
+// 发出收集器中剩余的输出，在结束消息后附上资源使用和输出统计；因超出限制被终止时替换结束消息
+QString Compiler::finishOutput(const QString &message, RunUsage usage)
+{
+    m_wallTimer->stop();
+    m_output->finish();
+    if (usage.wallMs == 0)
+        usage.wallMs = m_runClock.nsecsElapsed() / 1e6;
+    m_lastUsage = usage;
+
+    QString result = m_limitMessage.isEmpty() ? message : m_limitMessage;
+    if (!result.endsWith('\n'))
+        result += '\n';
+    result += usage.toString();
+    OutputCollector::Stats stats = m_output->stats();
+    if (stats.bytes > 0)
+        result += '\n' + stats.toString();
+    return result;
+}
+
+// 运行进程完成处理：获取输出、发送信号
 void Compiler::onRunProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     Q_UNUSED(exitStatus) // 未使用参数
 
-    // 获取程序输出
-    QString output = QString::fromLocal8Bit(m_runProcess->readAllStandardOutput());
-    QString error = QString::fromLocal8Bit(m_runProcess->readAllStandardError());
-
-    // 生成结果消息
-    QString result = QString("程序运行结束\n退出代码: %1\n").arg(exitCode);
-    if (!output.isEmpty())
-    {
-        result += "输出:\n" + output;
-    }
+    // 剩余输出同样经收集器发出，保证在结束消息之前显示
+    m_output->append(m_runProcess->readAllStandardOutput());
+    QByteArray error = m_runProcess->readAllStandardError();
     if (!error.isEmpty())
     {
-        result += "错误:\n" + error;
+        m_output->append("[ERROR] ");
+        m_output->append(error);
     }
 
-    // 清理可执行文件
-    if (!m_executablePath.isEmpty() && QFile::exists(m_executablePath))
-    {
-        QFile::remove(m_executablePath);
-    }
+    // 生成结果消息
+    QString result = finishOutput(QString("程序运行结束\n退出代码: %1\n").arg(exitCode));
+
+    // 可执行文件归编译缓存所有，运行结束后保留，供下次编译/运行直接复用
 
     // 发送运行完成信号
-    emit runFinished(exitCode == 0, result);
+    emit runFinished(exitCode == 0 && m_limitMessage.isEmpty(), result);
 }
 
@@ -3,18 +3,64 @@
 #define COMPILER_H
 
 #include <QObject>
+#include <QElapsedTimer>
 #include <QProcess>
-#include <QTemporaryFile>
+#include <QStringList>
+#include <QLockFile>
+#include <QScopedPointer>
+#include "benchmark.h"
+#include "buildprofile.h"
+#include "compilecache.h"
+#include "compilerbackend.h"
+#include "diagnostics.h"
+#include "runlimits.h"
+
+class OutputCollector;
+class PchCache;
+class QTimer;
+class RunProcess;
+class TccRunner;
 
 class Compiler : public QObject
 {
     Q_OBJECT
 public:
+    // 运行方式：交互模式下程序的输出及时显示；基准模式下标准输出经管道全缓冲，不影响程序性能
+    enum RunMode
+    {
+        InteractiveRun,
+        BenchmarkRun
+    };
+
     explicit Compiler(QObject *parent = nullptr);
     ~Compiler();
 
-    void compile(const QString &sourceCode);
+    // fileName用于把编译器诊断中的"<stdin>"映射回编辑器中的文件名
+    void compile(const QString &sourceCode, const QString &fileName = QString());
     void runProgram();
+    // 重复运行编译好的程序并统计耗时，结果由benchmarkFinished报告
+    void runBenchmark(const BenchmarkOptions &options);
+
+    // 构建配置，在下一次compile时生效
+    void setBuildProfile(const BuildProfile &profile);
+    BuildProfile buildProfile() const;
+
+    // 运行方式，在下一次运行时生效
+    void setRunMode(RunMode mode);
+    RunMode runMode() const;
+
+    // 运行限制，在下一次运行时生效
+    void setRunLimits(const RunLimits &limits);
+    RunLimits runLimits() const;
+    // 上一次运行的资源使用统计
+    RunUsage lastRunUsage() const;
+
+    // 内存中编译运行（libtcc）：不生成可执行文件，编译成功后立即运行；不支持时返回false
+    static bool isInMemoryRunSupported();
+    bool runInMemory(const QString &sourceCode, const QString &fileName = QString());
+
+    // 强制包含预置头文件的参数，让其他gcc调用看到与编译时相同的环境（参数匹配时可用上预编译头）
+    QStringList preludeArguments();
     void stopProgram();
     void sendInput(const QString &input);
 
@@ -23,18 +69,86 @@ signals:
     void compileFinished(bool success, const QString &output);
     void runFinished(bool success, const QString &output);
     void runOutput(const QString &output);
+    void benchmarkProgress(int completed, int total);
+    void benchmarkFinished(bool success, const BenchmarkResult &result, const QString &message);
+    // 编译过程中解析出的诊断，位置已映射回编辑器中的文件，一次编译可能分多批发出
+    void diagnosticsReceived(const QVector<Diagnostic> &diagnostics);
 
 private slots:
     void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void onRunProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void writeNextInputChunk();
+    void onCompilerStarted();
+    void onCompilerDiagnosticsReady();
+    void onCompilerError(QProcess::ProcessError error);
+    void onRunProcessError(QProcess::ProcessError error);
+    void onMemoryCompileFinished(bool success, const QString &diagnostics);
+    void onRunnerOutput(const QByteArray &data);
+    void onRunnerFinished(int exitCode, bool crashed, const QString &message, const RunUsage &usage);
+    void onWallTimeExceeded();
+    void onBenchmarkFinished(bool success, const BenchmarkResult &result, const QString &message);
 
 private:
-    QProcess *m_process;
-    QProcess *m_runProcess;
+    // 编译流程所处阶段：先预处理计算缓存键，未命中时再编译
+    enum Stage
+    {
+        Idle,
+        Preprocessing,
+        Compiling
+    };
+
+    void onPreprocessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onCompileStageFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void startCompilerProcess(const QStringList &arguments, const QByteArray &input);
+    void initScratchDirectory();
+    QString scratchDirectory() const;
+    bool writePrelude();
+    void probeDiagnosticsFormat();
+    QVector<Diagnostic> publishDiagnostics(QVector<Diagnostic> diagnostics);
+    void startRunClock();
+    void appendRunOutput(const QByteArray &data);
+    void abortRun(const QString &reason);
+    QString finishOutput(const QString &message, RunUsage usage = RunUsage());
+    QString takeStageErrors();
+    QString replayDiagnostics(const QByteArray &cached);
+    bool useJsonDiagnostics() const;
+    static void removeStaleScratchDirectories(const QString &root);
+
+    QProcess *m_process;    // 当前编译进程，每个阶段新建
+    QProcess *m_runProcess; // 当前运行进程，每次运行新建
+    TccRunner *m_memoryRunner; // 内存中编译运行
+    RunProcess *m_nativeRunner; // Unix上运行编译好的程序（伪终端或管道）
+    Benchmark *m_benchmark;     // 重复运行的基准测试
+    QObject *m_activeRunner = nullptr; // 当前运行使用的进程或运行器，其他运行器的输出和结束不再报告
+    RunMode m_runMode = InteractiveRun;
+    RunLimits m_limits;
+    RunUsage m_lastUsage;
+    QElapsedTimer m_runClock; // 本次运行的计时，运行器未提供耗时时使用
+    QTimer *m_wallTimer;      // 运行时间限制
+    QString m_limitMessage;   // 因超出限制被终止时的结束消息
+    PchCache *m_pch;           // 预置头文件的预编译头
+    OutputCollector *m_output; // 运行输出，合并后定时发出
     QString m_executablePath;
-    QString m_tempFilePath;
     bool m_compileSuccess;
     bool m_isTerminalOutput;
+
+    Stage m_stage = Idle;
+    CompileCache m_cache;
+    QString m_cacheKey;    // 本次编译的缓存键
+    QString m_stagingPath; // 未命中时编译器的输出路径
+    BuildProfile m_profile;    // 构建配置，参数参与缓存键计算
+    const CompilerBackend *m_backend = CompilerBackend::backend(BuildProfile::Gcc); // 本次编译使用的编译器
+    DiagnosticMapper m_mapper; // 本次编译的诊断映射
+    bool m_jsonDiagnostics = false;           // 当前gcc支持-fdiagnostics-format=json
+    bool m_byteColumns = false;               // 当前gcc支持-fdiagnostics-column-unit=byte
+    DiagnosticStreamParser m_diagnosticParser; // 当前阶段的JSON诊断解析状态
+    QString m_stageText;                       // 当前阶段已解析诊断的文本形式
+    QByteArray m_stageErrors;                  // 当前阶段的原始错误输出，编译阶段的随可执行文件缓存
+
+    QString m_scratchDir;                  // 本次会话的工作目录，优先位于tmpfs
+    QScopedPointer<QLockFile> m_scratchLock; // 会话锁，用于识别崩溃后遗留的工作目录
+    QByteArray m_stdinData;                // 正在写入编译器标准输入的数据
+    int m_stdinOffset = 0;
 };
 
 #endif // COMPILER_H
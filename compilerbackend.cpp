@@ -0,0 +1,156 @@
+#include "compilerbackend.h"
+#include <QStandardPaths>
+
+CompilerBackend::~CompilerBackend()
+{
+}
+
+QStringList CompilerBackend::compileFlags(const BuildProfile &profile) const
+{
+    return profile.compileFlags();
+}
+
+QStringList CompilerBackend::linkFlags(const BuildProfile &profile) const
+{
+    return profile.linkFlags();
+}
+
+QStringList CompilerBackend::preprocessArguments(const BuildProfile &profile, const QStringList &extra) const
+{
+    return QStringList() << "-E" << compileFlags(profile) << extra << "-x" << "c" << "-";
+}
+
+QStringList CompilerBackend::compileArguments(const BuildProfile &profile, const QString &output) const
+{
+    return QStringList() << "-x" << "cpp-output" << "-o" << output << "-"
+                         << compileFlags(profile) << linkFlags(profile);
+}
+
+bool CompilerBackend::hasJsonDiagnostics() const
+{
+    return false;
+}
+
+bool CompilerBackend::supportsPrecompiledHeaders() const
+{
+    return false;
+}
+
+QStringList CompilerBackend::precompileArguments(const BuildProfile &profile, const QString &header,
+                                                 const QString &output) const
+{
+    return QStringList() << "-x" << "c-header" << header << "-o" << output << compileFlags(profile);
+}
+
+bool CompilerBackend::isAvailable() const
+{
+    return !executablePath().isEmpty();
+}
+
+QString CompilerBackend::executablePath() const
+{
+    if (!m_detected)
+    {
+        m_executablePath = QStandardPaths::findExecutable(program());
+        m_detected = true;
+    }
+    return m_executablePath;
+}
+
+const CompilerBackend *CompilerBackend::backend(BuildProfile::Toolchain toolchain)
+{
+    static const GccBackend gcc;
+    static const ClangBackend clang;
+    static const TccBackend tcc;
+
+    switch (toolchain)
+    {
+    case BuildProfile::Clang:
+        return &clang;
+    case BuildProfile::Tcc:
+        return &tcc;
+    case BuildProfile::Gcc:
+    default:
+        return &gcc;
+    }
+}
+
+QList<BuildProfile::Toolchain> CompilerBackend::availableToolchains()
+{
+    QList<BuildProfile::Toolchain> result;
+    for (int i = 0; i < BuildProfile::ToolchainCount; ++i)
+    {
+        BuildProfile::Toolchain toolchain = BuildProfile::Toolchain(i);
+        if (backend(toolchain)->isAvailable())
+            result << toolchain;
+    }
+    return result;
+}
+
+BuildProfile::Toolchain CompilerBackend::quickRunToolchain()
+{
+    return backend(BuildProfile::Tcc)->isAvailable() ? BuildProfile::Tcc : BuildProfile::Gcc;
+}
+
+BuildProfile::Toolchain GccBackend::toolchain() const
+{
+    return BuildProfile::Gcc;
+}
+
+QString GccBackend::program() const
+{
+    return "gcc";
+}
+
+bool GccBackend::hasJsonDiagnostics() const
+{
+    return true;
+}
+
+bool GccBackend::supportsPrecompiledHeaders() const
+{
+    return true;
+}
+
+BuildProfile::Toolchain ClangBackend::toolchain() const
+{
+    return BuildProfile::Clang;
+}
+
+QString ClangBackend::program() const
+{
+    return "clang";
+}
+
+BuildProfile::Toolchain TccBackend::toolchain() const
+{
+    return BuildProfile::Tcc;
+}
+
+QString TccBackend::program() const
+{
+    return "tcc";
+}
+
+// tcc不做优化，也不认识-march、-flto等参数，只保留调试信息开关
+QStringList TccBackend::compileFlags(const BuildProfile &profile) const
+{
+    QStringList flags;
+    if (profile.optimization == BuildProfile::Debug)
+        flags << "-g";
+    return flags;
+}
+
+QStringList TccBackend::linkFlags(const BuildProfile &profile) const
+{
+    QStringList flags;
+    if (profile.linkage == BuildProfile::StaticLinkage)
+        flags << "-static";
+    return flags;
+}
+
+// tcc没有cpp-output输入类型，预处理结果本身就是合法的C代码（行标记为GNU格式，tcc可以识别）
+QStringList TccBackend::compileArguments(const BuildProfile &profile, const QString &output) const
+{
+    return QStringList() << "-o" << output << compileFlags(profile) << linkFlags(profile) << "-";
+}
@@ -0,0 +1,83 @@
+#ifndef COMPILERBACKEND_H
+#define COMPILERBACKEND_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "buildprofile.h"
+
+// 编译器后端：封装不同C编译器的程序名和命令行差异
+// 编译流程固定为两步：先把标准输入中的源码预处理到标准输出（用于计算缓存键），再编译标准输入中的预处理结果
+class CompilerBackend
+{
+public:
+    virtual ~CompilerBackend();
+
+    virtual BuildProfile::Toolchain toolchain() const = 0;
+    // 可执行文件名
+    virtual QString program() const = 0;
+
+    // 编译参数，预处理阶段同样使用
+    virtual QStringList compileFlags(const BuildProfile &profile) const;
+    // 链接参数
+    virtual QStringList linkFlags(const BuildProfile &profile) const;
+    // 预处理标准输入中的C源码，extra为附加参数（如强制包含的头文件）
+    virtual QStringList preprocessArguments(const BuildProfile &profile, const QStringList &extra) const;
+    // 把标准输入中的预处理结果编译链接为output
+    virtual QStringList compileArguments(const BuildProfile &profile, const QString &output) const;
+    // 是否可能支持-fdiagnostics-format=json（实际支持与否需要探测版本）
+    virtual bool hasJsonDiagnostics() const;
+    // 是否支持GCC格式的预编译头（-fpch-preprocess和.gch目录）
+    virtual bool supportsPrecompiledHeaders() const;
+    // 把头文件预编译为output，参数需与编译时一致，否则预编译头不会被采用
+    virtual QStringList precompileArguments(const BuildProfile &profile, const QString &header,
+                                            const QString &output) const;
+
+    // 在PATH中查找编译器，结果在首次调用时确定
+    bool isAvailable() const;
+    QString executablePath() const;
+
+    static const CompilerBackend *backend(BuildProfile::Toolchain toolchain);
+    // 启动时检测到的编译器
+    static QList<BuildProfile::Toolchain> availableToolchains();
+    // 快速运行使用的编译器：有tcc时用tcc，否则退回gcc
+    static BuildProfile::Toolchain quickRunToolchain();
+
+protected:
+    CompilerBackend() = default;
+
+private:
+    mutable bool m_detected = false;
+    mutable QString m_executablePath;
+};
+
+// GCC：默认后端
+class GccBackend : public CompilerBackend
+{
+public:
+    BuildProfile::Toolchain toolchain() const override;
+    QString program() const override;
+    bool hasJsonDiagnostics() const override;
+    bool supportsPrecompiledHeaders() const override;
+};
+
+// Clang：参数与GCC兼容
+class ClangBackend : public CompilerBackend
+{
+public:
+    BuildProfile::Toolchain toolchain() const override;
+    QString program() const override;
+};
+
+// TinyCC：编译速度比GCC快一个数量级，不做优化，适合编辑-运行循环
+class TccBackend : public CompilerBackend
+{
+public:
+    BuildProfile::Toolchain toolchain() const override;
+    QString program() const override;
+    QStringList compileFlags(const BuildProfile &profile) const override;
+    QStringList linkFlags(const BuildProfile &profile) const override;
+    QStringList compileArguments(const BuildProfile &profile, const QString &output) const override;
+};
+
+#endif // COMPILERBACKEND_H
@@ -0,0 +1,83 @@
+#include "decorationmanager.h"
+#include <QPlainTextEdit>
+#include <QTimer>
+
+DecorationManager::DecorationManager(QPlainTextEdit *editor)
+    : QObject(editor), m_editor(editor)
+{
+    for (int i = 0; i < LayerCount; ++i)
+        m_dirty[i] = false;
+}
+
+// 直接设置图层内容
+void DecorationManager::setLayer(Layer layer, const Selections &selections)
+{
+    m_layers[layer] = selections;
+    m_dirty[layer] = false;
+    scheduleFlush();
+}
+
+// 清空图层，本来为空时不触发刷新
+void DecorationManager::clearLayer(Layer layer)
+{
+    m_dirty[layer] = false;
+    if (m_layers[layer].isEmpty())
+        return;
+
+    m_layers[layer].clear();
+    scheduleFlush();
+}
+
+DecorationManager::Selections DecorationManager::layer(Layer layer) const
+{
+    return m_layers[layer];
+}
+
+bool DecorationManager::isLayerEmpty(Layer layer) const
+{
+    return m_layers[layer].isEmpty();
+}
+
+void DecorationManager::setProvider(Layer layer, const Provider &provider)
+{
+    m_providers[layer] = provider;
+    markDirty(layer);
+}
+
+// 标记图层需要重新生成
+void DecorationManager::markDirty(Layer layer)
+{
+    if (!m_providers[layer])
+        return;
+
+    m_dirty[layer] = true;
+    scheduleFlush();
+}
+
+// 安排在下一轮事件循环刷新，多次调用只刷新一次
+void DecorationManager::scheduleFlush()
+{
+    if (m_flushScheduled)
+        return;
+
+    m_flushScheduled = true;
+    QTimer::singleShot(0, this, &DecorationManager::flush);
+}
+
+// 重新生成脏图层，按顺序合并后一次性设置到编辑器
+void DecorationManager::flush()
+{
+    m_flushScheduled = false;
+
+    Selections merged;
+    for (int i = 0; i < LayerCount; ++i)
+    {
+        if (m_dirty[i])
+        {
+            m_layers[i] = m_providers[i]();
+            m_dirty[i] = false;
+        }
+        merged.append(m_layers[i]);
+    }
+    m_editor->setExtraSelections(merged);
+}
@@ -0,0 +1,55 @@
+#ifndef DECORATIONMANAGER_H
+#define DECORATIONMANAGER_H
+
+#include <QObject>
+#include <QList>
+#include <QTextEdit>
+#include <functional>
+
+class QPlainTextEdit;
+
+// 编辑器装饰管理：按图层保存ExtraSelection，每层单独标记是否需要重建，
+// 同一轮事件循环内的多次修改合并为一次setExtraSelections
+class DecorationManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 图层按绘制顺序排列，后面的覆盖前面的
+    enum Layer
+    {
+        CurrentLine,
+        SelectionOccurrences,
+        FindMatches,
+        Diagnostics,
+        BracketPair,
+        LayerCount
+    };
+
+    typedef QList<QTextEdit::ExtraSelection> Selections;
+    typedef std::function<Selections()> Provider;
+
+    explicit DecorationManager(QPlainTextEdit *editor);
+
+    // 设置/清空某层的选区内容
+    void setLayer(Layer layer, const Selections &selections);
+    void clearLayer(Layer layer);
+    Selections layer(Layer layer) const;
+    bool isLayerEmpty(Layer layer) const;
+
+    // 为图层注册生成函数，标记为脏后在刷新前重新生成
+    void setProvider(Layer layer, const Provider &provider);
+    void markDirty(Layer layer);
+
+private:
+    void scheduleFlush();
+    void flush();
+
+    QPlainTextEdit *m_editor;
+    Selections m_layers[LayerCount];
+    Provider m_providers[LayerCount];
+    bool m_dirty[LayerCount];
+    bool m_flushScheduled = false;
+};
+
+#endif // DECORATIONMANAGER_H
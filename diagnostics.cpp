@@ -0,0 +1,272 @@
+#include "diagnostics.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTextCodec>
+
+// UTF-8的MIB编号
+static const int kUtf8Mib = 106;
+
+QString Diagnostic::toString() const
+{
+    static const char *const names[] = {"error", "warning", "note"};
+    QString location = file;
+    if (line > 0)
+    {
+        location += ':' + QString::number(line);
+        if (column > 0)
+            location += ':' + QString::number(column);
+    }
+    return QString("%1: %2: %3").arg(location, names[severity], message);
+}
+
+// 编辑器中的制表符和多字节字符各占一个位置（代理对占两个）。源码以本地编码交给编译器，
+// 按本地编码长度逐个累加字节数：UTF-8直接计算，其他编码（如GBK中汉字占2字节）逐字符编码
+int Diagnostic::columnIndex(const QString &lineText, int column)
+{
+    const QTextCodec *codec = QTextCodec::codecForLocale();
+    const bool utf8 = codec->mibEnum() == kUtf8Mib;
+    int bytes = 0;
+    int index = 0;
+    while (index < lineText.length() && bytes < column - 1)
+    {
+        const ushort unicode = lineText.at(index).unicode();
+        const int length = (lineText.at(index).isHighSurrogate() && index + 1 < lineText.length() &&
+                            lineText.at(index + 1).isLowSurrogate()) ? 2 : 1;
+        if (unicode < 0x80)
+            bytes += 1;
+        else if (!utf8)
+            bytes += codec->fromUnicode(lineText.constData() + index, length).size();
+        else
+            bytes += length == 2 ? 4 : unicode < 0x800 ? 2 : 3;
+        index += length;
+    }
+    return index;
+}
+
+// 逐字节扫描，只跟踪字符串和括号深度，完整对象交给QJsonDocument解析
+QVector<Diagnostic> DiagnosticStreamParser::feed(const QByteArray &data)
+{
+    QVector<Diagnostic> diagnostics;
+    for (char c : data)
+    {
+        if (!m_inArray)
+        {
+            // 诊断数组总是从行首开始，其余文本按原样保留
+            if (c == '[' && m_atLineStart)
+                m_inArray = true;
+            else
+                m_plain.append(c);
+            m_atLineStart = (c == '\n');
+            continue;
+        }
+
+        if (m_depth == 0)
+        {
+            if (c == '{')
+            {
+                m_depth = 1;
+                m_element.append(c);
+            }
+            else if (c == ']')
+            {
+                m_inArray = false;
+                m_atLineStart = false;
+            }
+            continue; // 元素之间的逗号和空白
+        }
+
+        m_element.append(c);
+        if (m_inString)
+        {
+            if (m_escape)
+                m_escape = false;
+            else if (c == '\\')
+                m_escape = true;
+            else if (c == '"')
+                m_inString = false;
+            continue;
+        }
+
+        if (c == '"')
+            m_inString = true;
+        else if (c == '{' || c == '[')
+            ++m_depth;
+        else if ((c == '}' || c == ']') && --m_depth == 0)
+        {
+            QJsonDocument document = QJsonDocument::fromJson(m_element);
+            if (document.isObject())
+                appendDiagnostic(document.object(), &diagnostics);
+            m_element.clear();
+        }
+    }
+    return diagnostics;
+}
+
+QString DiagnosticStreamParser::takePlainText()
+{
+    QString text = QString::fromLocal8Bit(m_plain);
+    m_plain.clear();
+    return text;
+}
+
+void DiagnosticStreamParser::reset()
+{
+    m_element.clear();
+    m_plain.clear();
+    m_inArray = false;
+    m_atLineStart = true;
+    m_depth = 0;
+    m_inString = false;
+    m_escape = false;
+}
+
+// 位置对象中的字节列号：gcc 11起"column"随-fdiagnostics-column-unit默认按显示宽度计算（制表符展开），
+// 与编辑器中的字符位置不符，优先使用"byte-column"；更早的版本只有按字节计算的"column"
+static int jsonColumn(const QJsonObject &location)
+{
+    if (location.contains("byte-column"))
+        return location.value("byte-column").toInt();
+    return location.value("column").toInt();
+}
+
+void DiagnosticStreamParser::appendDiagnostic(const QJsonObject &object, QVector<Diagnostic> *diagnostics)
+{
+    Diagnostic diagnostic;
+    const QString kind = object.value("kind").toString();
+    if (kind == "warning")
+        diagnostic.severity = Diagnostic::Warning;
+    else if (kind == "note")
+        diagnostic.severity = Diagnostic::Note;
+    else
+        diagnostic.severity = Diagnostic::Error;
+
+    diagnostic.message = object.value("message").toString();
+    const QString option = object.value("option").toString();
+    if (!option.isEmpty())
+        diagnostic.message += " [" + option + "]";
+
+    const QJsonArray locations = object.value("locations").toArray();
+    if (!locations.isEmpty())
+    {
+        const QJsonObject caret = locations.first().toObject().value("caret").toObject();
+        diagnostic.file = caret.value("file").toString();
+        diagnostic.line = caret.value("line").toInt();
+        diagnostic.column = jsonColumn(caret);
+    }
+
+    const QJsonArray fixIts = object.value("fixits").toArray();
+    for (const QJsonValue &value : fixIts)
+    {
+        const QJsonObject fixItObject = value.toObject();
+        const QJsonObject start = fixItObject.value("start").toObject();
+        const QJsonObject next = fixItObject.value("next").toObject();
+        Diagnostic::FixIt fixIt;
+        fixIt.line = start.value("line").toInt();
+        fixIt.column = jsonColumn(start);
+        fixIt.endLine = next.value("line").toInt();
+        fixIt.endColumn = jsonColumn(next);
+        fixIt.replacement = fixItObject.value("string").toString();
+        diagnostic.fixIts.append(fixIt);
+    }
+    diagnostics->append(diagnostic);
+
+    const QJsonArray children = object.value("children").toArray();
+    for (const QJsonValue &child : children)
+        appendDiagnostic(child.toObject(), diagnostics);
+}
+
+DiagnosticMapper::DiagnosticMapper(const QString &displayName, int lineOffset,
+                                   const QString &sourceName)
+    : m_displayName(displayName.isEmpty() ? sourceName : displayName),
+      m_sourceName(sourceName),
+      m_lineOffset(lineOffset)
+{
+}
+
+QString DiagnosticMapper::displayName() const
+{
+    return m_displayName;
+}
+
+QString DiagnosticMapper::sourceName() const
+{
+    return m_sourceName;
+}
+
+const char *const DiagnosticMapper::kByteColumnsOption = "-fdiagnostics-column-unit=byte";
+
+// 逐行匹配"文件:行[:列]: 级别: 消息"，其他行（如"In function"、源码摘录）忽略
+QVector<Diagnostic> DiagnosticMapper::parse(const QString &output)
+{
+    static const QRegularExpression pattern(
+        R"(^(.+?):(\d+):(?:(\d+):)?\s*(fatal error|error|warning|note):\s*(.*)$)");
+
+    QVector<Diagnostic> diagnostics;
+    const QStringList lines = output.split('\n');
+    for (const QString &line : lines)
+    {
+        QRegularExpressionMatch match = pattern.match(line.trimmed());
+        if (!match.hasMatch())
+            continue;
+
+        Diagnostic diagnostic;
+        diagnostic.file = match.captured(1);
+        diagnostic.line = match.captured(2).toInt();
+        diagnostic.column = match.captured(3).toInt();
+        QString severity = match.captured(4);
+        if (severity == "warning")
+            diagnostic.severity = Diagnostic::Warning;
+        else if (severity == "note")
+            diagnostic.severity = Diagnostic::Note;
+        else
+            diagnostic.severity = Diagnostic::Error;
+        diagnostic.message = match.captured(5);
+        diagnostics.append(diagnostic);
+    }
+    return diagnostics;
+}
+
+bool DiagnosticMapper::map(Diagnostic *diagnostic) const
+{
+    if (diagnostic->file != m_sourceName)
+        return false;
+
+    diagnostic->file = m_displayName;
+    if (diagnostic->line > 0)
+        diagnostic->line = qMax(1, diagnostic->line - m_lineOffset);
+    for (Diagnostic::FixIt &fixIt : diagnostic->fixIts)
+    {
+        fixIt.line = qMax(1, fixIt.line - m_lineOffset);
+        fixIt.endLine = qMax(1, fixIt.endLine - m_lineOffset);
+    }
+    return true;
+}
+
+// 只改写以源文件名开头的位置前缀，其余内容原样保留
+QString DiagnosticMapper::mapText(const QString &output) const
+{
+    if (m_displayName == m_sourceName && m_lineOffset == 0)
+        return output;
+
+    const QRegularExpression prefix(
+        QString("^%1:(?:(\\d+):)?").arg(QRegularExpression::escape(m_sourceName)),
+        QRegularExpression::MultilineOption);
+
+    QString result;
+    int last = 0;
+    QRegularExpressionMatchIterator it = prefix.globalMatch(output);
+    while (it.hasNext())
+    {
+        QRegularExpressionMatch match = it.next();
+        result += output.midRef(last, match.capturedStart() - last);
+        result += m_displayName + ':';
+        if (match.capturedLength(1) > 0)
+            result += QString::number(qMax(1, match.captured(1).toInt() - m_lineOffset)) + ':';
+        last = match.capturedEnd();
+    }
+    result += output.midRef(last);
+    return result;
+}
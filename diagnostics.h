@@ -0,0 +1,93 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class QJsonObject;
+
+// 编译器给出的一条诊断信息，行号和列号从1开始，0表示没有；列号按源码本地编码的字节计算
+struct Diagnostic
+{
+    enum Severity
+    {
+        Error,
+        Warning,
+        Note
+    };
+
+    // 编译器建议的修改：把[起始位置, 结束位置)替换为replacement，结束位置不包含在内
+    struct FixIt
+    {
+        int line = 0;
+        int column = 0;
+        int endLine = 0;
+        int endColumn = 0;
+        QString replacement;
+    };
+
+    QString file;
+    int line = 0;
+    int column = 0;
+    Severity severity = Error;
+    QString message;
+    QVector<FixIt> fixIts;
+
+    // 按gcc文本格式输出（file:line:col: severity: message）
+    QString toString() const;
+    // 字节列号column（从1开始，按本地编码计算）在该行文本中对应的字符下标（从0开始），不超过行的长度
+    static int columnIndex(const QString &lineText, int column);
+};
+
+// 增量解析gcc -fdiagnostics-format=json的输出：随数据到达切分出完整的顶层诊断对象并立即解析，
+// 不必等到进程结束；JSON数组以外的文本（如链接器错误）原样保留
+class DiagnosticStreamParser
+{
+public:
+    // 追加一段输出，返回其中新解析出的诊断（子诊断展开为紧随其后的note）
+    QVector<Diagnostic> feed(const QByteArray &data);
+    // 取出JSON以外的文本
+    QString takePlainText();
+    void reset();
+
+private:
+    static void appendDiagnostic(const QJsonObject &object, QVector<Diagnostic> *diagnostics);
+
+    QByteArray m_element; // 尚未结束的顶层诊断对象
+    QByteArray m_plain;   // JSON以外的文本
+    bool m_inArray = false;
+    bool m_atLineStart = true;
+    int m_depth = 0;      // 当前对象内的嵌套深度
+    bool m_inString = false;
+    bool m_escape = false;
+};
+
+// 诊断映射：把编译器看到的源文件名和行号换算回编辑器中的文件名和行号
+// 源码经标准输入编译时gcc报告的文件名是"<stdin>"，lineOffset用于源码前面另有插入行的情况
+class DiagnosticMapper
+{
+public:
+    explicit DiagnosticMapper(const QString &displayName = QString(), int lineOffset = 0,
+                              const QString &sourceName = QStringLiteral("<stdin>"));
+
+    QString displayName() const;
+    QString sourceName() const;
+
+    // 解析gcc文本格式的诊断输出（file:line:col: severity: message），列号应为字节列
+    static QVector<Diagnostic> parse(const QString &output);
+    // 让gcc 11及以后的版本在文本诊断中按字节报告列号（默认按显示宽度），更早的版本不接受此选项
+    static const char *const kByteColumnsOption;
+
+    // 映射单条诊断，返回false表示诊断不属于用户源码（如来自预置头文件）
+    bool map(Diagnostic *diagnostic) const;
+    // 映射整段编译器输出中指向用户源码的位置前缀
+    QString mapText(const QString &output) const;
+
+private:
+    QString m_displayName;
+    QString m_sourceName;
+    int m_lineOffset;
+};
+
+#endif // DIAGNOSTICS_H
@@ -1,4 +1,5 @@
 #include "editor.h"
+#include "linediff.h"
 #include <QApplication>
 #include <QMainWindow>
 #include <QAction>
@@ -14,6 +15,10 @@
 #include <QScrollBar>
 #include <QTranslator>
 #include <QLibraryInfo>
+#include <QTimer>
+#include <QThread>
+#include <QToolTip>
+#include <algorithm>
 
 // 初始化编辑器组件和状态
 Editor::Editor(QWidget *parent) : QPlainTextEdit(parent),
@@ -21,7 +26,8 @@ Editor::Editor(QWidget *parent) : QPlainTextEdit(parent),
                                   copyAction(nullptr), pasteAction(nullptr),
                                   findAction(nullptr), replaceAction(nullptr),
                                   insertAction(nullptr), fontAction(nullptr),
-                                  lineNumberArea(new LineNumberArea(this))
+                                  lineNumberArea(new LineNumberArea(this)),
+                                  m_decorations(new DecorationManager(this))
 {
     // 加载中文本地化支持
     loadChineseTranslation();
@@ -37,8 +43,15 @@ Editor::Editor(QWidget *parent) : QPlainTextEdit(parent),
     // 更新动作状态
     updateActionStates();
 
-    // 初始化原始文本内容
-    m_originalText = toPlainText();
+    // 初始化原始文本的行哈希
+    rebuildLineHashes();
+    m_originalLineHashes = m_lineHashes;
+
+    // 当前行和查找结果两个装饰图层由编辑器状态生成，标记为脏后在刷新前重建
+    m_decorations->setProvider(DecorationManager::CurrentLine, [this]() { return currentLineSelections(); });
+    m_decorations->setProvider(DecorationManager::SelectionOccurrences, [this]() { return occurrenceSelections(); });
+    m_decorations->setProvider(DecorationManager::FindMatches, [this]() { return findMatchSelections(); });
+    m_decorations->setProvider(DecorationManager::Diagnostics, [this]() { return diagnosticSelections(); });
 
     // 初始化符号配对映射
     m_matchingPairs.insert('(', ')');
@@ -52,6 +65,7 @@ Editor::Editor(QWidget *parent) : QPlainTextEdit(parent),
     connect(this, &Editor::blockCountChanged, this, &Editor::updateLineNumberAreaWidth);
     connect(this, &Editor::updateRequest, this, &Editor::updateLineNumberArea);
     connect(this, &Editor::cursorPositionChanged, this, &Editor::highlightCurrentLine);
+    connect(document(), &QTextDocument::contentsChange, this, &Editor::onContentsChange);
     connect(this, &Editor::textChanged, this, &Editor::onTextChanged);
     connect(this, &Editor::cursorPositionChanged, this, &Editor::highlightMatchingBracket);
 
@@ -63,8 +77,14 @@ Editor::Editor(QWidget *parent) : QPlainTextEdit(parent),
     highlightCurrentLine();
     highlightNewLines();
 
-    // 初始化语法高亮器
+    // 初始化语法高亮器和括号索引
+    rebuildBracketIndex();
     highlighter = new EditorSyntaxHighlighter(document());
+    highlighter->setBracketIndex(&m_bracketIndex);
+    connect(highlighter, &EditorSyntaxHighlighter::backgroundPassFinished,
+            this, &Editor::refreshVisibleHighlight);
+    connect(this, &Editor::updateRequest, this, &Editor::refreshVisibleHighlight);
+    connect(this, &Editor::updateRequest, this, &Editor::refreshVisibleMatches);
 }
 
 // 计算当前行的缩进级别
@@ -107,16 +127,11 @@ int Editor::getIndentationLevel() const
 // 计算缩进字符串
 QString Editor::calculateIndentation() const
 {
-    QTextCursor cursor = textCursor();
-    cursor.movePosition(QTextCursor::StartOfLine);
-    cursor.movePosition(QTextCursor::EndOfLine, QTextCursor::KeepAnchor);
-    QString currentLine = cursor.selectedText();
-
     // 基础缩进级别
     int indentLevel = getIndentationLevel();
 
-    // 遇到{增加一级缩进
-    if (currentLine.contains('{') && !currentLine.contains('}'))
+    // 当前行有未闭合的{时增加一级缩进（字符串和注释中的括号不计）
+    if (m_bracketIndex.unclosedInBlock(BracketIndex::Brace, textCursor().blockNumber()) > 0)
     {
         indentLevel++;
     }
@@ -275,7 +290,7 @@ int Editor::lineNumberAreaWidth()
         ++digits;
     }
     int space = 3 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
-    return space;
+    return diagnosticMarkerWidth() + space;
 }
 
 // 绘制行号区域
@@ -289,16 +304,29 @@ void Editor::lineNumberAreaPaintEvent(QPaintEvent *event)
     int top = (int)blockBoundingGeometry(block).translated(contentOffset()).top();
     int bottom = top + (int)blockBoundingRect(block).height();
 
+    const QHash<int, Diagnostic::Severity> severities = diagnosticSeverityByBlock();
+    const int markerSize = diagnosticMarkerWidth() - 4;
+    painter.setRenderHint(QPainter::Antialiasing);
+
     // 绘制所有可见行号
     while (block.isValid() && top <= event->rect().bottom())
     {
         if (block.isVisible() && bottom >= event->rect().top())
         {
+            // 诊断标记：错误为红色，警告为橙色
+            auto severity = severities.constFind(blockNumber);
+            if (severity != severities.constEnd())
+            {
+                painter.setPen(Qt::NoPen);
+                painter.setBrush(*severity == Diagnostic::Error ? QColor(Qt::red) : QColor(230, 140, 0));
+                painter.drawEllipse(2, top + (fontMetrics().height() - markerSize) / 2, markerSize, markerSize);
+            }
+
             QString number = QString::number(blockNumber + 1);
             painter.setPen(Qt::black);
 
             // 新增行显示为红色
-            if (m_newLineNumbers.contains(blockNumber + 1))
+            if (blockNumber < m_newLineNumbers.size() && m_newLineNumbers.testBit(blockNumber))
                 painter.setPen(Qt::red);
 
             painter.drawText(0, top, lineNumberArea->width() - 3,
@@ -315,24 +343,25 @@ void Editor::lineNumberAreaPaintEvent(QPaintEvent *event)
 // 文本变化回调
 void Editor::onTextChanged()
 {
-    // 检查行数是否超过2000
-    if (document()->lineCount() > 2000) {
-        emit lineCountExceeded();
-    }
+    // 大文件自动切换到后台语法高亮
+    if (highlighter && !highlighter->isBackgroundEnabled() &&
+        document()->blockCount() > kBackgroundHighlightLines)
+        setBackgroundHighlighting(true);
+
     highlightNewLines();
     clearBracketHighlight();
 
 }
 void Editor::checkAndClearBracketHighlight()
 {
-    if (!m_bracketSelections.isEmpty())
+    if (!m_decorations->isLayerEmpty(DecorationManager::BracketPair))
     {
         QTextCursor cursor = textCursor();
         QTextDocument *doc = document();
 
         // 检查高亮的括号是否还存在
         bool shouldClear = false;
-        for (const auto &selection : m_bracketSelections)
+        for (const auto &selection : m_decorations->layer(DecorationManager::BracketPair))
         {
             int bracketPos = selection.cursor.position();
             if (bracketPos >= doc->characterCount() ||
@@ -358,48 +387,97 @@ void Editor::checkAndClearBracketHighlight()
 // 高亮新增行（与原始文本对比）
 void Editor::highlightNewLines()
 {
-    m_newLineNumbers.clear();
-    QString currentText = toPlainText();
-    QStringList originalLines = m_originalText.split('\n');
-    QStringList currentLines = currentText.split('\n');
-
-    // 使用LCS算法标记新增行
-    int m = originalLines.size();
-    int n = currentLines.size();
-    QVector<QVector<int>> lcs(m + 1, QVector<int>(n + 1, 0));
-
-    // 计算最长公共子序列
-    for (int i = 1; i <= m; ++i)
-        for (int j = 1; j <= n; ++j)
-            lcs[i][j] = (originalLines[i - 1] == currentLines[j - 1]) ? lcs[i - 1][j - 1] + 1 : qMax(lcs[i - 1][j], lcs[i][j - 1]);
-
-    // 标记匹配的行
-    QSet<int> matchedOriginalLines, matchedCurrentLines;
-    int i = m, j = n;
-    while (i > 0 && j > 0)
+    // 行哈希由onContentsChange增量维护，这里只对变化后的哈希序列做差异比较
+    if (m_lineDiffDirty)
     {
-        if (originalLines[i - 1] == currentLines[j - 1])
-        {
-            matchedOriginalLines.insert(i - 1);
-            matchedCurrentLines.insert(j - 1);
-            i--;
-            j--;
-        }
-        else if (lcs[i - 1][j] > lcs[i][j - 1])
-            i--;
-        else
-            j--;
+        m_newLineNumbers = LineDiff::addedLines(m_originalLineHashes, m_lineHashes);
+        m_lineDiffDirty = false;
     }
 
-    // 标记未匹配的当前行为新增行
-    for (int k = 0; k < currentLines.size(); ++k)
-        if (!matchedCurrentLines.contains(k))
-            m_newLineNumbers.insert(k + 1);
-
     lineNumberArea->update();
     highlightCurrentLine();
 }
 
+// 文档内容变化：只重新计算受影响块的行哈希
+void Editor::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    QTextDocument *doc = document();
+    QTextBlock firstBlock = doc->findBlock(position);
+    QTextBlock lastBlock = doc->findBlock(position + charsAdded);
+    if (!firstBlock.isValid())
+    {
+        rebuildLineHashes();
+        rebuildBracketIndex();
+        findAllMatches();
+        updateFindDecorations();
+        return;
+    }
+    if (!lastBlock.isValid())
+        lastBlock = doc->lastBlock();
+
+    // 新文档中受影响的块为[first, last]，旧文档中对应[first, last - delta]
+    int first = firstBlock.blockNumber();
+    int last = lastBlock.blockNumber();
+    int delta = doc->blockCount() - m_lineHashes.size();
+    int oldLast = last - delta;
+    if (last < first || oldLast < first || oldLast >= m_lineHashes.size())
+    {
+        rebuildLineHashes();
+        rebuildBracketIndex();
+        findAllMatches();
+        updateFindDecorations();
+        return;
+    }
+
+    QVector<quint64> newHashes;
+    newHashes.reserve(last - first + 1);
+    for (QTextBlock block = firstBlock; block.isValid() && block.blockNumber() <= last; block = block.next())
+        newHashes.append(LineDiff::hashLine(block.text()));
+
+    // 仅格式变化（如语法高亮）时哈希不变，无需重新比较
+    if (delta == 0 && std::equal(newHashes.constBegin(), newHashes.constEnd(),
+                                 m_lineHashes.constBegin() + first))
+        return;
+
+    m_lineHashes.remove(first, oldLast - first + 1);
+    m_lineHashes.insert(first, newHashes.size(), 0);
+    std::copy(newHashes.constBegin(), newHashes.constEnd(), m_lineHashes.begin() + first);
+    m_lineDiffDirty = true;
+
+    // 括号索引同步增删块，新块的括号摘要随后由高亮器填入
+    m_bracketIndex.replaceBlocks(first, oldLast - first + 1, last - first + 1);
+    updateMatchesAfterEdit(position, charsRemoved, charsAdded);
+    if (!m_searchText.isEmpty())
+        updateFindDecorations();
+    // 所选内容的高亮只反映高亮时的文本，编辑后清除
+    clearOccurrences();
+}
+
+// 重新计算整个文档的行哈希
+void Editor::rebuildLineHashes()
+{
+    QTextDocument *doc = document();
+    m_lineHashes.clear();
+    m_lineHashes.reserve(doc->blockCount());
+    for (QTextBlock block = doc->begin(); block.isValid(); block = block.next())
+        m_lineHashes.append(LineDiff::hashLine(block.text()));
+    m_lineDiffDirty = true;
+}
+
+// 从各块缓存的词法单元重建括号索引，尚未分词的块暂按没有括号处理
+void Editor::rebuildBracketIndex()
+{
+    QTextDocument *doc = document();
+    m_bracketIndex.reset(doc->blockCount());
+    int number = 0;
+    for (QTextBlock block = doc->begin(); block.isValid(); block = block.next(), ++number)
+    {
+        BlockLexData *data = static_cast<BlockLexData *>(block.userData());
+        if (data && data->outState >= 0)
+            m_bracketIndex.setBlock(number, block.text(), data->tokens);
+    }
+}
+
 // 更新行号区域宽度
 void Editor::updateLineNumberAreaWidth(int /* newBlockCount */)
 {
@@ -426,12 +504,22 @@ void Editor::resizeEvent(QResizeEvent *event)
     lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), lineNumberAreaWidth(), cr.height()));
 }
 
-// 高亮当前行和查找匹配
+// 高亮当前行：只标记图层，实际刷新合并到下一轮事件循环
 void Editor::highlightCurrentLine()
 {
-    QList<QTextEdit::ExtraSelection> extraSelections;
+    m_decorations->markDirty(DecorationManager::CurrentLine);
+}
 
-    // 当前行高亮
+// 查找结果变化后重建查找图层
+void Editor::updateFindDecorations()
+{
+    m_decorations->markDirty(DecorationManager::FindMatches);
+}
+
+// 当前行图层
+QList<QTextEdit::ExtraSelection> Editor::currentLineSelections() const
+{
+    QList<QTextEdit::ExtraSelection> selections;
     if (!isReadOnly())
     {
         QTextEdit::ExtraSelection selection;
@@ -439,44 +527,169 @@ void Editor::highlightCurrentLine()
         selection.format.setProperty(QTextFormat::FullWidthSelection, true);
         selection.cursor = textCursor();
         selection.cursor.clearSelection();
-        extraSelections.append(selection);
+        selections.append(selection);
     }
+    return selections;
+}
 
-    // 查找匹配高亮
-    for (int i = 0; i < m_matchCursors.size(); ++i)
-    {
-        const QTextCursor &mc = m_matchCursors[i];
-        if (mc.isNull())
-            continue;
+// 查找图层：可见范围内的匹配项和当前匹配项
+QList<QTextEdit::ExtraSelection> Editor::findMatchSelections()
+{
+    QTextCharFormat matchFormat;
+    matchFormat.setBackground(QColor(Qt::cyan).lighter(180));
+    QList<QTextEdit::ExtraSelection> selections = visibleMatchSelections(m_matchPositions, m_searchText.length(),
+                                                                         matchFormat);
 
-        QTextEdit::ExtraSelection matchSel;
-        matchSel.format.setBackground(QColor(Qt::cyan).lighter(180));
-        matchSel.cursor = mc;
-        extraSelections.append(matchSel);
+    QTextBlock firstVisible, lastVisible;
+    visibleBlockRange(&firstVisible, &lastVisible);
+    m_matchViewStart = firstVisible.isValid() ? firstVisible.position() : -1;
+    m_matchViewEnd = lastVisible.isValid() ? lastVisible.position() + lastVisible.length() : -1;
+
+    if (m_currentMatchIndex >= 0 && m_currentMatchIndex < m_matchPositions.size())
+    {
+        QTextEdit::ExtraSelection curSel;
+        curSel.format.setBackground(QColor(Qt::blue).lighter(170));
+        curSel.cursor = matchCursor(m_currentMatchIndex);
+        selections.append(curSel);
     }
+    return selections;
+}
 
-    // 当前匹配项高亮
-    if (m_currentMatchIndex >= 0 && m_currentMatchIndex < m_matchCursors.size())
+// "高亮所选"图层：颜色比查找结果浅，两者同时存在时查找结果在上层
+QList<QTextEdit::ExtraSelection> Editor::occurrenceSelections() const
+{
+    QTextCharFormat format;
+    format.setBackground(QColor(Qt::yellow).lighter(160));
+    return visibleMatchSelections(m_occurrencePositions, m_occurrenceText.length(), format);
+}
+
+void Editor::clearOccurrences()
+{
+    if (m_occurrenceText.isEmpty())
+        return;
+    m_occurrenceText.clear();
+    m_occurrencePositions.clear();
+    m_decorations->markDirty(DecorationManager::SelectionOccurrences);
+}
+
+// 获取装饰管理器，供外部设置诊断等图层
+DecorationManager *Editor::decorations() const
+{
+    return m_decorations;
+}
+
+// 设置诊断，note级别的附加说明只在提示中显示，不单独标记
+void Editor::setDiagnostics(const QVector<Diagnostic> &diagnostics)
+{
+    m_diagnosticMarks.clear();
+    QTextDocument *doc = document();
+    for (const Diagnostic &diagnostic : diagnostics)
     {
-        QTextCursor cur = m_matchCursors[m_currentMatchIndex];
-        if (!cur.isNull())
+        if (diagnostic.severity == Diagnostic::Note)
         {
-            QTextEdit::ExtraSelection curSel;
-            curSel.format.setBackground(QColor(Qt::blue).lighter(170));
-            curSel.cursor = cur;
-            extraSelections.append(curSel);
+            if (!m_diagnosticMarks.isEmpty())
+                m_diagnosticMarks.last().message += "\n" + diagnostic.message;
+            continue;
         }
+
+        QTextBlock block = doc->findBlockByNumber(diagnostic.line - 1);
+        if (!block.isValid())
+            continue;
+
+        // gcc的列号按字节计算，换算为字符位置，并扩展到所在的单词
+        const QString text = block.text();
+        int start = 0;
+        int end = text.length();
+        if (diagnostic.column > 0)
+        {
+            start = qMin(Diagnostic::columnIndex(text, diagnostic.column), qMax(0, text.length() - 1));
+            end = start;
+            while (end < text.length() && (text.at(end).isLetterOrNumber() || text.at(end) == '_'))
+                ++end;
+            end = qMin(text.length(), qMax(end, start + 1));
+        }
+        else
+        {
+            while (start < end && text.at(start).isSpace())
+                ++start;
+        }
+
+        DiagnosticMark mark;
+        mark.cursor = QTextCursor(doc);
+        mark.cursor.setPosition(block.position() + start);
+        mark.cursor.setPosition(block.position() + end, QTextCursor::KeepAnchor);
+        mark.severity = diagnostic.severity;
+        mark.message = diagnostic.message;
+        m_diagnosticMarks.append(mark);
+    }
+
+    m_decorations->markDirty(DecorationManager::Diagnostics);
+    lineNumberArea->update();
+}
+
+void Editor::clearDiagnostics()
+{
+    setDiagnostics(QVector<Diagnostic>());
+}
+
+// 诊断图层：错误用红色波浪线，警告用橙色波浪线
+QList<QTextEdit::ExtraSelection> Editor::diagnosticSelections() const
+{
+    QList<QTextEdit::ExtraSelection> selections;
+    for (const DiagnosticMark &mark : m_diagnosticMarks)
+    {
+        QTextEdit::ExtraSelection selection;
+        selection.cursor = mark.cursor;
+        selection.format.setUnderlineStyle(QTextCharFormat::WaveUnderline);
+        selection.format.setUnderlineColor(mark.severity == Diagnostic::Error ? QColor(Qt::red)
+                                                                                : QColor(230, 140, 0));
+        selections.append(selection);
     }
+    return selections;
+}
 
-    // 添加括号高亮
-    extraSelections.append(m_bracketSelections);
-    setExtraSelections(extraSelections);
+// 每行最严重的诊断级别
+QHash<int, Diagnostic::Severity> Editor::diagnosticSeverityByBlock() const
+{
+    QHash<int, Diagnostic::Severity> severities;
+    for (const DiagnosticMark &mark : m_diagnosticMarks)
+    {
+        int blockNumber = mark.cursor.block().blockNumber();
+        auto it = severities.find(blockNumber);
+        if (it == severities.end() || mark.severity < *it)
+            severities.insert(blockNumber, mark.severity);
+    }
+    return severities;
+}
+
+// 行号区左侧诊断标记列的宽度
+int Editor::diagnosticMarkerWidth() const
+{
+    return fontMetrics().height() / 2 + 4;
+}
+
+// 鼠标停在诊断标记所在行时显示诊断内容
+void Editor::showDiagnosticToolTip(QHelpEvent *event)
+{
+    QTextBlock block = cursorForPosition(QPoint(0, event->pos().y())).block();
+    QStringList messages;
+    for (const DiagnosticMark &mark : m_diagnosticMarks)
+    {
+        if (mark.cursor.block() == block)
+            messages << (mark.severity == Diagnostic::Error ? "错误: " : "警告: ") + mark.message;
+    }
+
+    if (messages.isEmpty())
+        QToolTip::hideText();
+    else
+        QToolTip::showText(event->globalPos(), messages.join("\n"), lineNumberArea);
 }
 
 // 设置原始文本（用于对比新增内容）
 void Editor::setOriginalText(const QString &text)
 {
-    m_originalText = text;
+    m_originalLineHashes = LineDiff::hashLines(text);
+    m_lineDiffDirty = true;
     highlightNewLines();
 }
 
@@ -739,13 +952,40 @@ void Editor::handleFind()
     if (!ok || searchText.isEmpty())
         return;
 
+    QTextDocument::FindFlags flags;
+    if (!askMatchMode(tr("查找"), &flags))
+        return;
+
     m_searchText = searchText;
-    m_searchFlags = QTextDocument::FindFlags();
+    m_searchFlags = flags;
     highlightAllMatches();
 
     // 跳转到第一个匹配
-    if (m_currentMatchIndex >= 0 && m_currentMatchIndex < m_matchCursors.size())
-        setTextCursor(m_matchCursors[m_currentMatchIndex]);
+    if (m_currentMatchIndex >= 0 && m_currentMatchIndex < m_matchPositions.size())
+        setTextCursor(matchCursor(m_currentMatchIndex));
+}
+
+// 选择匹配方式，默认沿用上次的选择；查找和替换共用，取消时返回false
+bool Editor::askMatchMode(const QString &title, QTextDocument::FindFlags *flags)
+{
+    QStringList modes;
+    modes << tr("区分大小写") << tr("不区分大小写")
+          << tr("全字匹配（区分大小写）") << tr("全字匹配（不区分大小写）");
+    int current = (m_searchFlags & QTextDocument::FindCaseSensitively ? 0 : 1) +
+                  (m_searchFlags & QTextDocument::FindWholeWords ? 2 : 0);
+    bool ok;
+    QString mode = QInputDialog::getItem(this, title, tr("请选择匹配方式:"),
+                                         modes, current, false, &ok);
+    if (!ok)
+        return false;
+
+    int modeIndex = modes.indexOf(mode);
+    *flags = QTextDocument::FindFlags();
+    if (modeIndex % 2 == 0)
+        *flags |= QTextDocument::FindCaseSensitively;
+    if (modeIndex >= 2)
+        *flags |= QTextDocument::FindWholeWords;
+    return true;
 }
 
 // 处理替换
@@ -771,17 +1011,25 @@ void Editor::handleReplace()
 
     // 选择替换方式
     QStringList options;
-    options << tr("替换当前匹配项") << tr("替换所有匹配项");
+    options << tr("替换当前匹配项") << tr("替换所有匹配项") << tr("替换所有匹配项（正则表达式，\\1引用捕获组）");
     QString choice = QInputDialog::getItem(this, tr("替换选项"),
                                            tr("请选择操作:"), options, 0, false, &ok);
     if (!ok)
         return;
 
+    // 与查找相同地选择匹配方式，替换按所选方式匹配，同时成为当前的查找条件
+    QTextDocument::FindFlags flags;
+    if (!askMatchMode(tr("替换"), &flags))
+        return;
+    m_searchText = searchText;
+    m_searchFlags = flags;
+    highlightAllMatches();
+
     // 执行替换
     if (choice == options[0])
         replaceCurrent(searchText, replaceText);
     else
-        replaceAll(searchText, replaceText);
+        replaceAll(searchText, replaceText, choice == options[2]);
 
     highlightNewLines();
 }
@@ -789,9 +1037,9 @@ void Editor::handleReplace()
 // 替换当前匹配项
 void Editor::replaceCurrent(const QString &searchText, const QString &replaceText)
 {
-    if (m_currentMatchIndex >= 0 && m_currentMatchIndex < m_matchCursors.size())
+    if (m_currentMatchIndex >= 0 && m_currentMatchIndex < m_matchPositions.size())
     {
-        QTextCursor c = m_matchCursors[m_currentMatchIndex];
+        QTextCursor c = matchCursor(m_currentMatchIndex);
         c.beginEditBlock();
         c.insertText(replaceText);
         c.endEditBlock();
@@ -799,7 +1047,7 @@ void Editor::replaceCurrent(const QString &searchText, const QString &replaceTex
     }
     else
     {
-        QTextCursor cursor = document()->find(searchText, textCursor());
+        QTextCursor cursor = document()->find(searchText, textCursor(), m_searchFlags);
         if (!cursor.isNull())
         {
             cursor.insertText(replaceText);
@@ -810,21 +1058,110 @@ void Editor::replaceCurrent(const QString &searchText, const QString &replaceTex
     }
 }
 
-// 替换所有匹配项
-void Editor::replaceAll(const QString &searchText, const QString &replaceText)
+// 展开替换文本：\N引用第N个捕获组（组存在时可为两位数），另支持\n、\t和\\
+static void appendReplacement(QString &result, const QString &replacement,
+                              const QRegularExpressionMatch &match)
 {
-    QTextCursor cursor(document());
+    const int length = replacement.length();
+    for (int i = 0; i < length; ++i)
+    {
+        QChar c = replacement.at(i);
+        if (c != QLatin1Char('\\') || i + 1 >= length)
+        {
+            result += c;
+            continue;
+        }
+
+        QChar next = replacement.at(++i);
+        if (next.isDigit())
+        {
+            int group = next.digitValue();
+            if (i + 1 < length && replacement.at(i + 1).isDigit())
+            {
+                int twoDigits = group * 10 + replacement.at(i + 1).digitValue();
+                if (twoDigits <= match.lastCapturedIndex())
+                {
+                    group = twoDigits;
+                    ++i;
+                }
+            }
+            result += match.captured(group);
+        }
+        else if (next == QLatin1Char('n'))
+            result += QLatin1Char('\n');
+        else if (next == QLatin1Char('t'))
+            result += QLatin1Char('\t');
+        else
+            result += next;
+    }
+}
+
+// 替换所有匹配项：在文本快照上一次扫描得到全部匹配，拼接出替换后的文本，
+// 再作为一个编辑块写回，只产生一次撤销步骤和一次重新高亮
+void Editor::replaceAll(const QString &searchText, const QString &replaceText, bool useRegex)
+{
+    const QString snapshot = toPlainText();
+    QString result;
+    int spanStart = -1; // 第一个匹配的起点，此前的文本保持不变
+    int copied = 0;     // 快照中已经拷贝到result的位置
     int count = 0;
-    cursor.beginEditBlock();
 
-    while (!(cursor = document()->find(searchText, cursor)).isNull())
+    if (useRegex)
+    {
+        // 全字匹配时整个表达式前后加单词边界
+        const QString pattern = m_searchFlags & QTextDocument::FindWholeWords
+                                    ? QString("\\b(?:%1)\\b").arg(searchText)
+                                    : searchText;
+        QRegularExpression regex(pattern, m_searchFlags & QTextDocument::FindCaseSensitively
+                                              ? QRegularExpression::NoPatternOption
+                                              : QRegularExpression::CaseInsensitiveOption);
+        if (!regex.isValid())
+        {
+            showStatusMessage(tr("正则表达式无效: %1").arg(regex.errorString()), 5000);
+            return;
+        }
+
+        QRegularExpressionMatchIterator it = regex.globalMatch(snapshot);
+        while (it.hasNext())
+        {
+            QRegularExpressionMatch match = it.next();
+            if (spanStart < 0)
+                spanStart = copied = match.capturedStart();
+            result += snapshot.midRef(copied, match.capturedStart() - copied);
+            appendReplacement(result, replaceText, match);
+            copied = match.capturedEnd();
+            ++count;
+        }
+    }
+    else
+    {
+        TextSearch search(searchText, searchOptions());
+        for (int pos = search.indexIn(snapshot); pos != -1; pos = search.indexIn(snapshot, pos + searchText.length()))
+        {
+            if (spanStart < 0)
+                spanStart = copied = pos;
+            result += snapshot.midRef(copied, pos - copied);
+            result += replaceText;
+            copied = pos + searchText.length();
+            ++count;
+        }
+    }
+
+    if (count == 0)
     {
-        cursor.insertText(replaceText);
-        ++count;
+        showStatusMessage(tr("未找到匹配的文本: %1").arg(searchText), 3000);
+        return;
     }
 
+    // 只替换从第一个匹配到最后一个匹配之间的区间
+    QTextCursor cursor(document());
+    cursor.beginEditBlock();
+    cursor.setPosition(spanStart);
+    cursor.setPosition(copied, QTextCursor::KeepAnchor);
+    cursor.insertText(result);
     cursor.endEditBlock();
-    qDebug() << "共替换" << count << "处匹配文本";
+
+    showStatusMessage(tr("共替换 %1 处匹配文本").arg(count), 3000);
     highlightAllMatches();
 }
 
@@ -843,7 +1180,7 @@ void Editor::handleInsert()
     setTextCursor(cursor);
 }
 
-// 高亮选中文本的所有匹配项
+// 高亮选中文本的所有出现位置（区分大小写）；使用单独的图层，不改变查找条件和查找结果
 void Editor::highlightSelection()
 {
     QTextCursor sel = textCursor();
@@ -859,22 +1196,17 @@ void Editor::highlightSelection()
     selectedText.replace("\r\n", "\n");
     selectedText.replace('\r', '\n');
 
-    m_searchText = selectedText;
-    m_searchFlags = QTextDocument::FindFlags();
-    highlightAllMatches();
-
-    // 跳转到第一个匹配
-    if (m_currentMatchIndex >= 0 && m_currentMatchIndex < m_matchCursors.size())
-    {
-        setTextCursor(m_matchCursors[m_currentMatchIndex]);
-        highlightCurrentLine();
-    }
+    m_occurrenceText = selectedText;
+    m_occurrencePositions = TextSearch(m_occurrenceText, TextSearch::NoOptions).findAll(toPlainText());
+    m_decorations->markDirty(DecorationManager::SelectionOccurrences);
+    showStatusMessage(tr("所选内容共出现 %1 处").arg(m_occurrencePositions.size()), 3000);
 }
 
 // 清除所有高亮
 void Editor::clearAllHighlights()
 {
     clearFindHighlights();
+    clearOccurrences();
 }
 
 // 处理字体设置
@@ -969,33 +1301,198 @@ void Editor::handleComment()
 // 高亮所有匹配项
 void Editor::highlightAllMatches()
 {
-    m_matchCursors.clear();
+    findAllMatches();
+    m_currentMatchIndex = m_matchPositions.isEmpty() ? -1 : 0;
+    updateFindDecorations();
+    showMatchCount();
+}
+
+// 在全文中查找所有匹配，只记录起始位置
+void Editor::findAllMatches()
+{
+    m_matchPositions.clear();
     if (m_searchText.isEmpty())
     {
         m_currentMatchIndex = -1;
-        highlightCurrentLine();
         return;
     }
 
-    QString search = m_searchText;
-    search.replace(QChar::ParagraphSeparator, '\n');
-    search.replace("\r\n", "\n");
-    search.replace('\r', '\n');
+    m_matchPositions = TextSearch(m_searchText, searchOptions()).findAll(toPlainText());
+
+    if (m_currentMatchIndex >= m_matchPositions.size())
+        m_currentMatchIndex = m_matchPositions.size() - 1;
+}
 
-    // 在全文中查找所有匹配
-    QString docText = toPlainText();
-    int pos = docText.indexOf(search, 0);
-    while (pos != -1)
+// 文档编辑后调整匹配位置：编辑点之后的匹配整体平移，只重新扫描编辑点附近的文本
+void Editor::updateMatchesAfterEdit(int position, int charsRemoved, int charsAdded)
+{
+    if (m_searchText.isEmpty())
+        return;
+
+    const int length = m_searchText.length();
+    const int oldCount = m_matchPositions.size();
+    // 全字匹配时，编辑点两侧紧邻的字符也会影响单词边界的判断
+    const int reach = (m_searchFlags & QTextDocument::FindWholeWords) ? 1 : 0;
+
+    // 旧文档中与被删除区间重叠或跨越编辑点的匹配被移除，其后的匹配平移
+    QVector<int>::iterator first = std::lower_bound(m_matchPositions.begin(), m_matchPositions.end(),
+                                                    position - length + 1 - reach);
+    QVector<int>::iterator last = std::lower_bound(first, m_matchPositions.end(),
+                                                   position + charsRemoved + reach);
+    for (QVector<int>::iterator it = last; it != m_matchPositions.end(); ++it)
+        *it += charsAdded - charsRemoved;
+    int firstIndex = first - m_matchPositions.begin();
+    int removedCount = last - first;
+    m_matchPositions.remove(firstIndex, removedCount);
+
+    // 新匹配的起点位于[scanStart, position + charsAdded)，且不能与前后保留的匹配重叠
+    int scanStart = qMax(0, position - length + 1 - reach);
+    if (firstIndex > 0)
+        scanStart = qMax(scanStart, m_matchPositions[firstIndex - 1] + length);
+    int scanLimit = position + charsAdded + reach;
+    int docEnd = document()->characterCount() - 1;
+    int scanEnd = qMin(scanLimit + length - 1, docEnd);
+    if (firstIndex < m_matchPositions.size())
+        scanEnd = qMin(scanEnd, m_matchPositions[firstIndex]);
+
+    QVector<int> found;
+    if (scanEnd - scanStart >= length)
     {
-        QTextCursor c(document());
-        c.setPosition(pos);
-        c.setPosition(pos + search.length(), QTextCursor::KeepAnchor);
-        m_matchCursors.push_back(c);
-        pos = docText.indexOf(search, pos + qMax(1, search.length()));
+        // 两侧各多取一个字符作为单词边界的上下文
+        int contextStart = qMax(0, scanStart - 1);
+        int contextEnd = qMin(docEnd, scanEnd + 1);
+        QTextCursor cursor(document());
+        cursor.setPosition(contextStart);
+        cursor.setPosition(contextEnd, QTextCursor::KeepAnchor);
+        QString text = cursor.selectedText();
+        text.replace(QChar::ParagraphSeparator, '\n');
+
+        TextSearch search(m_searchText, searchOptions());
+        int end = scanEnd - contextStart;
+        for (int pos = search.indexIn(text.constData(), text.length(), scanStart - contextStart, end);
+             pos != -1 && contextStart + pos < scanLimit;
+             pos = search.indexIn(text.constData(), text.length(), pos + length, end))
+            found.append(contextStart + pos);
     }
+    m_matchPositions.insert(firstIndex, found.size(), 0);
+    std::copy(found.constBegin(), found.constEnd(), m_matchPositions.begin() + firstIndex);
+
+    // 当前匹配项：编辑点之后的随之平移，被移除的落到编辑点处
+    if (m_currentMatchIndex >= firstIndex + removedCount)
+        m_currentMatchIndex += found.size() - removedCount;
+    else if (m_currentMatchIndex >= firstIndex)
+        m_currentMatchIndex = firstIndex;
+    if (m_currentMatchIndex >= m_matchPositions.size())
+        m_currentMatchIndex = m_matchPositions.size() - 1;
+
+    if (m_matchPositions.size() != oldCount)
+        showMatchCount();
+}
 
-    m_currentMatchIndex = m_matchCursors.isEmpty() ? -1 : 0;
-    highlightCurrentLine();
+// 将查找标志转换为查找内核的选项
+TextSearch::Options Editor::searchOptions() const
+{
+    TextSearch::Options options;
+    if (!(m_searchFlags & QTextDocument::FindCaseSensitively))
+        options |= TextSearch::CaseInsensitive;
+    if (m_searchFlags & QTextDocument::FindWholeWords)
+        options |= TextSearch::WholeWord;
+    return options;
+}
+
+// 根据匹配位置构造选中该匹配项的光标
+QTextCursor Editor::matchCursor(int index) const
+{
+    QTextCursor cursor(document());
+    cursor.setPosition(m_matchPositions[index]);
+    cursor.setPosition(m_matchPositions[index] + m_searchText.length(), QTextCursor::KeepAnchor);
+    return cursor;
+}
+
+// 为可见范围内的匹配项生成高亮选区，匹配数量再多也只创建屏幕上的那部分
+QList<QTextEdit::ExtraSelection> Editor::visibleMatchSelections(const QVector<int> &positions, int length,
+                                                                const QTextCharFormat &format) const
+{
+    QList<QTextEdit::ExtraSelection> selections;
+    if (positions.isEmpty())
+        return selections;
+
+    QTextBlock first, last;
+    visibleBlockRange(&first, &last);
+    if (!first.isValid())
+        return selections;
+
+    // 起点在首个可见块之前、但延伸进视口的匹配也要包含
+    int from = first.position() - length + 1;
+    int to = last.position() + last.length();
+    QVector<int>::const_iterator begin = std::lower_bound(positions.constBegin(), positions.constEnd(), from);
+    QVector<int>::const_iterator end = std::lower_bound(begin, positions.constEnd(), to);
+    for (QVector<int>::const_iterator it = begin; it != end; ++it)
+    {
+        QTextEdit::ExtraSelection selection;
+        selection.format = format;
+        selection.cursor = QTextCursor(document());
+        selection.cursor.setPosition(*it);
+        selection.cursor.setPosition(*it + length, QTextCursor::KeepAnchor);
+        selections.append(selection);
+    }
+    return selections;
+}
+
+// 计算视口中第一个和最后一个可见块
+void Editor::visibleBlockRange(QTextBlock *first, QTextBlock *last) const
+{
+    *first = firstVisibleBlock();
+    *last = *first;
+    qreal top = blockBoundingGeometry(*first).translated(contentOffset()).top();
+    int bottom = viewport()->height();
+    for (QTextBlock block = *first; block.isValid() && top <= bottom; block = block.next())
+    {
+        *last = block;
+        top += blockBoundingRect(block).height();
+    }
+}
+
+// 滚动或改变大小后可见范围变化时，重新生成查找高亮和所选内容的高亮
+void Editor::refreshVisibleMatches()
+{
+    if (m_matchPositions.isEmpty() && m_occurrencePositions.isEmpty())
+        return;
+
+    QTextBlock first, last;
+    visibleBlockRange(&first, &last);
+    int start = first.isValid() ? first.position() : -1;
+    int end = last.isValid() ? last.position() + last.length() : -1;
+    if (start == m_matchViewStart && end == m_matchViewEnd)
+        return;
+
+    m_matchViewStart = start;
+    m_matchViewEnd = end;
+    if (!m_matchPositions.isEmpty())
+        updateFindDecorations();
+    if (!m_occurrencePositions.isEmpty())
+        m_decorations->markDirty(DecorationManager::SelectionOccurrences);
+}
+
+// 在状态栏显示匹配数量
+void Editor::showMatchCount()
+{
+    if (m_searchText.isEmpty())
+        showStatusMessage(QString());
+    else if (m_matchPositions.isEmpty())
+        showStatusMessage(tr("未找到匹配项: %1").arg(m_searchText));
+    else if (m_currentMatchIndex < 0)
+        showStatusMessage(tr("共 %1 处匹配").arg(m_matchPositions.size()));
+    else
+        showStatusMessage(tr("第 %1/%2 处匹配").arg(m_currentMatchIndex + 1).arg(m_matchPositions.size()));
+}
+
+// 在主窗口状态栏显示消息
+void Editor::showStatusMessage(const QString &message, int timeout)
+{
+    QMainWindow *mainWindow = qobject_cast<QMainWindow *>(window());
+    if (mainWindow && mainWindow->statusBar())
+        mainWindow->statusBar()->showMessage(message, timeout);
 }
 
 // 查找下一个匹配
@@ -1004,7 +1501,7 @@ void Editor::findNext()
     if (m_searchText.isEmpty())
         return;
 
-    if (m_matchCursors.isEmpty())
+    if (m_matchPositions.isEmpty())
     {
         QTextCursor c = document()->find(m_searchText, textCursor(), m_searchFlags);
         if (!c.isNull())
@@ -1012,13 +1509,10 @@ void Editor::findNext()
         return;
     }
 
-    m_currentMatchIndex = (m_currentMatchIndex + 1) % m_matchCursors.size();
-    QTextCursor target = m_matchCursors[m_currentMatchIndex];
-    if (!target.isNull())
-    {
-        setTextCursor(target);
-        highlightCurrentLine();
-    }
+    m_currentMatchIndex = (m_currentMatchIndex + 1) % m_matchPositions.size();
+    setTextCursor(matchCursor(m_currentMatchIndex));
+    updateFindDecorations();
+    showMatchCount();
 }
 
 // 查找上一个匹配
@@ -1027,7 +1521,7 @@ void Editor::findPrevious()
     if (m_searchText.isEmpty())
         return;
 
-    if (m_matchCursors.isEmpty())
+    if (m_matchPositions.isEmpty())
     {
         QTextCursor c = document()->find(m_searchText, textCursor(), m_searchFlags | QTextDocument::FindBackward);
         if (!c.isNull())
@@ -1035,33 +1529,30 @@ void Editor::findPrevious()
         return;
     }
 
-    m_currentMatchIndex = (m_currentMatchIndex - 1 + m_matchCursors.size()) % m_matchCursors.size();
-    QTextCursor target = m_matchCursors[m_currentMatchIndex];
-    if (!target.isNull())
-    {
-        setTextCursor(target);
-        highlightCurrentLine();
-    }
+    m_currentMatchIndex = (m_currentMatchIndex - 1 + m_matchPositions.size()) % m_matchPositions.size();
+    setTextCursor(matchCursor(m_currentMatchIndex));
+    updateFindDecorations();
+    showMatchCount();
 }
 
 // 清除查找高亮
 void Editor::clearFindHighlights()
 {
     m_searchText.clear();
-    m_matchCursors.clear();
+    m_matchPositions.clear();
     m_currentMatchIndex = -1;
-    highlightCurrentLine();
+    updateFindDecorations();
+    showMatchCount();
 }
 
 // 清除所有高亮
 void Editor::clearHighlights()
 {
-    m_matchCursors.clear();
+    m_matchPositions.clear();
     m_searchText.clear();
     m_currentMatchIndex = -1;
     highlightAllMatches();
-    m_selectionExtraSelections.clear();
-    setExtraSelections(baseExtraSelections());
+    clearOccurrences();
 }
 
 // 设置高亮动作
@@ -1076,77 +1567,28 @@ void Editor::setHighlightActions(QAction *highlightAction, QAction *clearHighlig
         connect(clearHighlightsAction, &QAction::triggered, this, &Editor::clearHighlights);
 }
 
-// 获取基础高亮选区
-QList<QTextEdit::ExtraSelection> Editor::baseExtraSelections() const
-{
-    QList<QTextEdit::ExtraSelection> extraSelections;
-
-    // 当前行高亮
-    if (!isReadOnly())
-    {
-        QTextEdit::ExtraSelection selection;
-        selection.format.setBackground(QColor(Qt::yellow).lighter(190));
-        selection.format.setProperty(QTextFormat::FullWidthSelection, true);
-        selection.cursor = textCursor();
-        selection.cursor.clearSelection();
-        extraSelections.append(selection);
-    }
-
-    // 查找结果高亮
-    QTextCharFormat matchFormat;
-    matchFormat.setBackground(Qt::yellow);
-    for (const QTextCursor &cursor : m_matchCursors)
-    {
-        QTextEdit::ExtraSelection matchSelection;
-        matchSelection.format = matchFormat;
-        matchSelection.cursor = cursor;
-        extraSelections.append(matchSelection);
-    }
-
-    // 手动选中高亮
-    extraSelections.append(m_selectionExtraSelections);
-    return extraSelections;
-}
-
-// 高亮匹配括号
 // 高亮匹配括号
 void Editor::highlightMatchingBracket()
 {
-    // 清除旧的高亮
-    m_bracketSelections.clear();
-
     QTextCursor cursor = textCursor();
     int position = cursor.position();
     QTextDocument *doc = document();
 
-    // 检查当前字符和前一个字符
-    QChar currentChar, prevChar;
-    if (position > 0)
-        prevChar = doc->characterAt(position - 1);
-    if (position < doc->characterCount())
-        currentChar = doc->characterAt(position);
-
     int matchPos = -1;
+    BracketIndex::Kind kind;
+    bool open = false;
 
-    // 左括号匹配
-    if (m_matchingPairs.contains(prevChar))
+    // 左括号匹配：光标前一个字符
+    if (position > 0 && BracketIndex::bracketKind(doc->characterAt(position - 1), &kind, &open) && open)
     {
-        QChar matchChar = m_matchingPairs[prevChar];
-        matchPos = findMatchingBracket(position - 1, prevChar, matchChar, 1);
+        matchPos = findMatchingBracket(position - 1);
         if (matchPos != -1)
             highlightBracketPair(position - 1, matchPos);
     }
-    // 右括号匹配
-    else if (m_matchingPairs.values().contains(currentChar))
+    // 右括号匹配：光标后一个字符
+    else if (BracketIndex::bracketKind(doc->characterAt(position), &kind, &open) && !open)
     {
-        QChar matchChar;
-        for (auto it = m_matchingPairs.begin(); it != m_matchingPairs.end(); ++it)
-            if (it.value() == currentChar)
-            {
-                matchChar = it.key();
-                break;
-            }
-        matchPos = findMatchingBracket(position, currentChar, matchChar, -1);
+        matchPos = findMatchingBracket(position);
         if (matchPos != -1)
             highlightBracketPair(matchPos, position);
     }
@@ -1157,55 +1599,74 @@ void Editor::highlightMatchingBracket()
         clearBracketHighlight();
     }
 }
-// 查找匹配括号
-int Editor::findMatchingBracket(int startPos, QChar bracket, QChar matchBracket, int direction)
-{
-    QTextDocument *doc = document();
-    int depth = 1;
-    int currentPos = startPos + direction;
 
-    // 处理字符串内的括号
-    static QSet<QChar> quotes = {'"', '\''};
-    static bool inString = false;
-    static QChar currentQuote;
-
-    while (currentPos >= 0 && currentPos < doc->characterCount())
+// 在块内从tokens[from]开始扫描同类括号，深度降到0时返回列号，否则返回-1并保留剩余深度
+static int scanBlockBrackets(const QString &text, const QVector<CLexer::Token> &tokens,
+                             BracketIndex::Kind kind, bool forward, int from, int &depth)
+{
+    int step = forward ? 1 : -1;
+    for (int i = from; i >= 0 && i < tokens.size(); i += step)
     {
-        QChar c = doc->characterAt(currentPos);
-
-        // 字符串检测
-        if (quotes.contains(c))
-        {
-            if (!inString)
-            {
-                inString = true;
-                currentQuote = c;
-            }
-            else if (c == currentQuote)
-                inString = false;
-            currentPos += direction;
-            continue;
-        }
-        if (inString)
-        {
-            currentPos += direction;
+        const CLexer::Token &token = tokens[i];
+        BracketIndex::Kind tokenKind;
+        bool open;
+        if (token.type != CLexer::Bracket || token.start >= text.length() ||
+            !BracketIndex::bracketKind(text.at(token.start), &tokenKind, &open) || tokenKind != kind)
             continue;
-        }
 
-        // 括号匹配
-        if (c == bracket)
-            depth++;
-        else if (c == matchBracket)
-        {
-            depth--;
-            if (depth == 0)
-                return currentPos;
-        }
+        depth += open == forward ? 1 : -1;
+        if (depth == 0)
+            return token.start;
+    }
+    return -1;
+}
 
-        currentPos += direction;
+// 查找匹配括号：先在本块内扫描，再由括号索引定位匹配所在的块
+int Editor::findMatchingBracket(int bracketPos) const
+{
+    QTextBlock block = document()->findBlock(bracketPos);
+    BlockLexData *data = block.isValid() ? static_cast<BlockLexData *>(block.userData()) : nullptr;
+    const QString text = block.text();
+    if (!data || data->outState < 0 || data->textHash != qHash(text))
+        return -1;
+
+    int column = bracketPos - block.position();
+    BracketIndex::Kind kind;
+    bool open;
+    if (column >= text.length() || !BracketIndex::bracketKind(text.at(column), &kind, &open))
+        return -1;
+
+    // 只有词法分析器识别出的括号才参与匹配，字符串和注释中的括号被忽略
+    const QVector<CLexer::Token> &tokens = data->tokens;
+    int index = -1;
+    for (int i = 0; i < tokens.size() && index < 0; ++i)
+    {
+        if (tokens[i].type == CLexer::Bracket && tokens[i].start == column)
+            index = i;
     }
+    if (index < 0)
+        return -1;
 
-    return -1;
+    int depth = 1;
+    int match = scanBlockBrackets(text, tokens, kind, open, open ? index + 1 : index - 1, depth);
+    if (match >= 0)
+        return block.position() + match;
+
+    int depthAtBlock = 0;
+    int number = open ? m_bracketIndex.findForward(kind, block.blockNumber() + 1, depth, &depthAtBlock)
+                      : m_bracketIndex.findBackward(kind, block.blockNumber() - 1, depth, &depthAtBlock);
+    if (number < 0)
+        return -1;
+
+    QTextBlock target = document()->findBlockByNumber(number);
+    data = static_cast<BlockLexData *>(target.userData());
+    if (!data)
+        return -1;
+
+    const QString targetText = target.text();
+    match = scanBlockBrackets(targetText, data->tokens, kind, open,
+                              open ? 0 : data->tokens.size() - 1, depthAtBlock);
+    return match >= 0 ? target.position() + match : -1;
 }
 
 // 高亮括号对
@@ -1230,34 +1691,14 @@ void Editor::highlightBracketPair(int pos1, int pos2)
     selection2.cursor.setPosition(pos2);
     selection2.cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
 
-    m_bracketSelections.clear();
-    m_bracketSelections.append(selection1);
-    m_bracketSelections.append(selection2);
-    updateBracketHighlight();
+    m_decorations->setLayer(DecorationManager::BracketPair,
+                            QList<QTextEdit::ExtraSelection>() << selection1 << selection2);
 }
 
 // 清除括号高亮
 void Editor::clearBracketHighlight()
 {
-    if (!m_bracketSelections.isEmpty())
-    {
-        m_bracketSelections.clear();
-        updateBracketHighlight();
-    }
-}
-
-// 更新括号高亮显示
-void Editor::updateBracketHighlight()
-{
-    QList<QTextEdit::ExtraSelection> selections = extraSelections();
-
-    // 移除旧括号高亮
-    for (int i = selections.size() - 1; i >= 0; --i)
-        if (selections[i].format.background().color() == QColor(255, 255, 153))
-            selections.removeAt(i);
-
-    selections.append(m_bracketSelections);
-    setExtraSelections(selections);
+    m_decorations->clearLayer(DecorationManager::BracketPair);
 }
 
 // 鼠标滚轮事件：Ctrl+滚轮调整字体大小
@@ -1290,112 +1731,349 @@ void Editor::wheelEvent(QWheelEvent *event)
 EditorSyntaxHighlighter::EditorSyntaxHighlighter(QTextDocument *parent)
     : QSyntaxHighlighter(parent)
 {
-    // 设置关键字格式
+    // 关键字格式（关键字表见CLexer）
     keywordFormat.setForeground(Qt::darkBlue);
     keywordFormat.setFontWeight(QFont::Bold);
 
-    // C++关键字列表
-    QStringList keywordPatterns = {
-        "\\bchar\\b", "\\bclass\\b", "\\bconst\\b",
-        "\\bdouble\\b", "\\benum\\b", "\\bexplicit\\b",
-        "\\bfriend\\b", "\\binline\\b", "\\bint\\b",
-        "\\blong\\b", "\\bnamespace\\b", "\\boperator\\b",
-        "\\bprivate\\b", "\\bprotected\\b", "\\bpublic\\b",
-        "\\bshort\\b", "\\bsignals\\b", "\\bsigned\\b",
-        "\\bslots\\b", "\\bstatic\\b", "\\bstruct\\b",
-        "\\btemplate\\b", "\\btypedef\\b", "\\btypename\\b",
-        "\\bunion\\b", "\\bunsigned\\b", "\\bvirtual\\b",
-        "\\bvoid\\b", "\\bvolatile\\b", "\\bbool\\b",
-        "\\bif\\b", "\\belse\\b", "\\bswitch\\b", "\\bcase\\b",
-        "\\bdefault\\b", "\\bfor\\b", "\\bwhile\\b", "\\bdo\\b",
-        "\\breturn\\b", "\\bbreak\\b", "\\bcontinue\\b", "\\bdelete\\b",
-        "\\bnew\\b", "\\bthis\\b", "\\bsizeof\\b", "\\btrue\\b", "\\bfalse\\b"};
-
-    // 添加关键字规则
-    for (const QString &pattern : keywordPatterns)
-        highlightingRules.append({QRegularExpression(pattern), keywordFormat});
-
     // 类名格式（Qt类）
     classFormat.setForeground(Qt::darkMagenta);
     classFormat.setFontWeight(QFont::Bold);
-    highlightingRules.append({QRegularExpression("\\bQ[A-Za-z]+\\b"), classFormat});
 
     // 函数格式
     functionFormat.setForeground(Qt::darkCyan);
-    highlightingRules.append({QRegularExpression("\\b[A-Za-z0-9_]+(?=\\()"), functionFormat});
 
     // 字符串格式
     quotationFormat.setForeground(Qt::darkGreen);
-    highlightingRules.append({QRegularExpression("\".*\""), quotationFormat});
-    highlightingRules.append({QRegularExpression("'.*'"), quotationFormat});
 
     // 数字格式
     numberFormat.setForeground(Qt::darkRed);
-    highlightingRules.append({QRegularExpression("\\b[0-9]+\\b"), numberFormat});
-    highlightingRules.append({QRegularExpression("\\b0x[0-9A-Fa-f]+\\b"), numberFormat});
-    highlightingRules.append({QRegularExpression("\\b[0-9]+\\.[0-9]+\\b"), numberFormat});
 
     // 单行注释格式
     singleLineCommentFormat.setForeground(Qt::gray);
-    highlightingRules.append({QRegularExpression("//[^\n]*"), singleLineCommentFormat});
 
     // 多行注释格式
     multiLineCommentFormat.setForeground(Qt::gray);
-    commentStartExpression = QRegularExpression("/\\*");
-    commentEndExpression = QRegularExpression("\\*/");
+
+    // 预处理指令格式
+    preprocessorFormat.setForeground(Qt::darkYellow);
+
+    // 后台分词请求合并定时器
+    m_backgroundTimer = new QTimer(this);
+    m_backgroundTimer->setSingleShot(true);
+    m_backgroundTimer->setInterval(kBackgroundDelayMs);
+    connect(m_backgroundTimer, &QTimer::timeout, this, &EditorSyntaxHighlighter::startBackgroundPass);
+}
+
+// 语法高亮器析构：取消未完成的后台任务并结束工作线程
+EditorSyntaxHighlighter::~EditorSyntaxHighlighter()
+{
+    if (m_workerThread)
+    {
+        m_worker->cancelBefore(m_generation + 1);
+        m_workerThread->quit();
+        m_workerThread->wait();
+    }
+}
+
+// 词法单元类型对应的格式
+const QTextCharFormat &EditorSyntaxHighlighter::formatFor(CLexer::TokenType type) const
+{
+    switch (type)
+    {
+    case CLexer::Keyword:
+        return keywordFormat;
+    case CLexer::ClassName:
+        return classFormat;
+    case CLexer::Function:
+        return functionFormat;
+    case CLexer::String:
+    case CLexer::Char:
+        return quotationFormat;
+    case CLexer::Number:
+        return numberFormat;
+    case CLexer::LineComment:
+        return singleLineCommentFormat;
+    case CLexer::Preprocessor:
+        return preprocessorFormat;
+    case CLexer::BlockComment:
+    default:
+        return multiLineCommentFormat;
+    }
 }
 
-// 应用语法高亮规则
+// 分词并按词法单元设置格式，结果缓存在块的用户数据中
 void EditorSyntaxHighlighter::highlightBlock(const QString &text)
 {
-    // 应用单行规则
-    for (const HighlightingRule &rule : qAsConst(highlightingRules))
+    if (!m_sliceStarted)
+        beginSlice();
+
+    int inState = qMax(previousBlockState(), 0);
+    uint hash = qHash(text);
+    BlockLexData *data = static_cast<BlockLexData *>(currentBlockUserData());
+    if (!data)
     {
-        QRegularExpressionMatchIterator matchIterator = rule.pattern.globalMatch(text);
-        while (matchIterator.hasNext())
+        data = new BlockLexData;
+        setCurrentBlockUserData(data);
+    }
+
+    // 文本和行首状态都未变化时直接复用缓存，行末状态相同则级联自然停止
+    if (data->outState < 0 || data->textHash != hash || data->inState != inState)
+    {
+        bool sameText = data->outState >= 0 && data->textHash == hash;
+
+        // 后台模式：超出时间片的块交给工作线程，暂时保留旧格式且不改变块状态
+        if (m_backgroundEnabled && m_sliceTimer.elapsed() > kBackgroundSliceBudgetMs)
+        {
+            if (sameText)
+                applyTokens(data->tokens);
+            updateBracketIndex(text, sameText ? data->tokens : QVector<CLexer::Token>());
+            data->applied = false;
+            requestBackgroundPass();
+            return;
+        }
+
+        // 文本未变、只因上一行状态变化而级联到此：超出时间片则保留旧结果，稍后继续
+        if (sameText && m_sliceTimer.elapsed() > kSliceBudgetMs)
         {
-            QRegularExpressionMatch match = matchIterator.next();
-            setFormat(match.capturedStart(), match.capturedLength(), rule.format);
+            applyTokens(data->tokens);
+            updateBracketIndex(text, data->tokens);
+            setCurrentBlockState(data->outState);
+            deferCascade(currentBlock());
+            return;
         }
+
+        data->outState = CLexer::tokenize(text, inState, data->tokens);
+        data->inState = inState;
+        data->textHash = hash;
+    }
+
+    applyTokens(data->tokens);
+    updateBracketIndex(text, data->tokens);
+    data->applied = true;
+    setCurrentBlockState(data->outState);
+}
+
+// 按词法单元设置格式
+void EditorSyntaxHighlighter::applyTokens(const QVector<CLexer::Token> &tokens)
+{
+    for (const CLexer::Token &token : tokens)
+    {
+        if (token.type != CLexer::Bracket)
+            setFormat(token.start, token.length, formatFor(token.type));
     }
+}
 
-    // 处理多行注释
-    setCurrentBlockState(0);
-    int startIndex = 0;
-    if (previousBlockState() != 1)
-        startIndex = text.indexOf(commentStartExpression);
+// 设置括号索引
+void EditorSyntaxHighlighter::setBracketIndex(BracketIndex *index)
+{
+    m_bracketIndex = index;
+}
+
+// 将当前块的括号写入索引
+void EditorSyntaxHighlighter::updateBracketIndex(const QString &text, const QVector<CLexer::Token> &tokens)
+{
+    if (m_bracketIndex)
+        m_bracketIndex->setBlock(currentBlock().blockNumber(), text, tokens);
+}
+
+// 开始新的时间片，到下一轮事件循环时自动结束
+void EditorSyntaxHighlighter::beginSlice()
+{
+    m_sliceTimer.start();
+    if (!m_sliceStarted)
+    {
+        m_sliceStarted = true;
+        QTimer::singleShot(0, this, [this]() { m_sliceStarted = false; });
+    }
+}
+
+// 记录被推迟的级联起点，在下一轮事件循环中继续
+void EditorSyntaxHighlighter::deferCascade(const QTextBlock &block)
+{
+    if (m_pendingCascades.isEmpty())
+        QTimer::singleShot(0, this, &EditorSyntaxHighlighter::continueCascade);
+    m_pendingCascades.append(QTextCursor(block));
+}
+
+// 启用/关闭后台分词，首次启用时创建工作线程
+void EditorSyntaxHighlighter::setBackgroundEnabled(bool enabled)
+{
+    if (m_backgroundEnabled == enabled)
+        return;
+    m_backgroundEnabled = enabled;
+
+    if (enabled && !m_workerThread)
+    {
+        qRegisterMetaType<HighlightResult>("HighlightResult");
+
+        m_workerThread = new QThread(this);
+        m_worker = new HighlightWorker;
+        m_worker->moveToThread(m_workerThread);
+        connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+        connect(this, &EditorSyntaxHighlighter::backgroundPassRequested,
+                m_worker, &HighlightWorker::tokenize);
+        connect(m_worker, &HighlightWorker::finished,
+                this, &EditorSyntaxHighlighter::onBackgroundPassFinished);
+        m_workerThread->start(QThread::LowPriority);
+    }
+
+    if (enabled)
+        requestBackgroundPass();
+}
+
+bool EditorSyntaxHighlighter::isBackgroundEnabled() const
+{
+    return m_backgroundEnabled;
+}
+
+// 合并短时间内的多次请求：每次请求重新计时，编辑停顿后才发起一次后台分词
+void EditorSyntaxHighlighter::requestBackgroundPass()
+{
+    m_backgroundTimer->start();
+}
+
+// 对文档快照发起后台分词，同时取消尚未完成的旧任务
+void EditorSyntaxHighlighter::startBackgroundPass()
+{
+    if (!m_backgroundEnabled || !m_worker)
+        return;
+
+    ++m_generation;
+    m_worker->cancelBefore(m_generation);
+    QTextDocument *doc = document();
+    emit backgroundPassRequested(m_generation, doc->revision(), doc->blockCount(), doc->toRawText());
+}
+
+// 后台分词完成：修订号仍匹配时写入各块缓存，格式只在块可见时才应用
+void EditorSyntaxHighlighter::onBackgroundPassFinished(const HighlightResult &result)
+{
+    QTextDocument *doc = document();
+    // 已有更新的任务在进行时，由那次任务的结果负责
+    if (!m_backgroundEnabled || result.generation != m_generation)
+        return;
+    // 分词期间文档又被修改：结果作废，重新请求，否则超出时间片被推迟的块会一直没有正确的格式和状态
+    if (result.revision != doc->revision() || result.blocks.size() != doc->blockCount())
+    {
+        requestBackgroundPass();
+        return;
+    }
 
-    while (startIndex >= 0)
+    QTextBlock block = doc->begin();
+    int number = 0;
+    for (const BlockLexResult &lexed : result.blocks)
     {
-        QRegularExpressionMatch match = commentEndExpression.match(text, startIndex);
-        int endIndex = match.capturedStart();
-        int commentLength = 0;
+        BlockLexData *data = static_cast<BlockLexData *>(block.userData());
+        if (!data)
+        {
+            data = new BlockLexData;
+            block.setUserData(data);
+        }
 
-        if (endIndex == -1)
+        bool unchanged = data->applied && data->textHash == lexed.textHash &&
+                         data->inState == lexed.inState && data->outState == lexed.outState;
+        if (!unchanged)
         {
-            setCurrentBlockState(1);
-            commentLength = text.length() - startIndex;
+            data->inState = lexed.inState;
+            data->outState = lexed.outState;
+            data->textHash = lexed.textHash;
+            data->tokens = lexed.tokens;
+            data->applied = false;
+            if (m_bracketIndex)
+                m_bracketIndex->setBlock(number, block.text(), data->tokens);
         }
-        else
+        block.setUserState(lexed.outState);
+        block = block.next();
+        ++number;
+    }
+
+    emit backgroundPassFinished();
+}
+
+// 将范围内格式过期的块更新为缓存结果
+void EditorSyntaxHighlighter::refreshRange(const QTextBlock &first, const QTextBlock &last)
+{
+    if (!first.isValid())
+        return;
+
+    int lastNumber = last.isValid() ? last.blockNumber() : first.blockNumber();
+    for (QTextBlock block = first; block.isValid() && block.blockNumber() <= lastNumber; block = block.next())
+    {
+        BlockLexData *data = static_cast<BlockLexData *>(block.userData());
+        if (data && !data->applied)
         {
-            commentLength = endIndex - startIndex + match.capturedLength();
+            beginSlice();
+            rehighlightBlock(block);
         }
+    }
+}
+
+// 继续被推迟的级联重新高亮，每次使用新的时间片
+void EditorSyntaxHighlighter::continueCascade()
+{
+    QVector<QTextCursor> pending;
+    pending.swap(m_pendingCascades);
 
-        setFormat(startIndex, commentLength, multiLineCommentFormat);
-        startIndex = text.indexOf(commentStartExpression, startIndex + commentLength);
+    beginSlice();
+    for (const QTextCursor &cursor : qAsConst(pending))
+    {
+        QTextBlock block = cursor.block();
+        if (block.isValid())
+            rehighlightBlock(block);
     }
 }
 
 
-bool Editor::isLineCountValid() const {
-    return document()->blockCount() <= 2000;
+// 启用/关闭后台语法高亮
+void Editor::setBackgroundHighlighting(bool enabled)
+{
+    if (highlighter)
+        highlighter->setBackgroundEnabled(enabled);
+}
+
+// 后台分词结果只应用到可见的块，滚动时再更新新出现的块
+void Editor::refreshVisibleHighlight()
+{
+    if (!highlighter || !highlighter->isBackgroundEnabled())
+        return;
+
+    QTextBlock first, last;
+    visibleBlockRange(&first, &last);
+    highlighter->refreshRange(first, last);
+}
+
+// 设置行数软限制：超过后只提示一次，不再阻止编辑
+void Editor::setLineSoftLimit(int limit)
+{
+    m_lineSoftLimit = qMax(1, limit);
+    m_lineLimitWarned = false;
+    checkLineCountLimit();
+}
+
+// 获取行数软限制
+int Editor::lineSoftLimit() const
+{
+    return m_lineSoftLimit;
+}
+
+bool Editor::isLineCountValid() const
+{
+    return document()->blockCount() <= m_lineSoftLimit;
 }
 
-void Editor::checkLineCountLimit() {
-    if (document()->blockCount() > 2000) {
-        // 阻止进一步输入并提示用户
-        undo(); // 撤销最后一次操作（即超限的输入）
-        emit lineCountExceeded();
+// 检查行数是否越过软限制，每次越过只发出一次提示
+void Editor::checkLineCountLimit()
+{
+    if (document()->blockCount() > m_lineSoftLimit)
+    {
+        if (!m_lineLimitWarned)
+        {
+            m_lineLimitWarned = true;
+            emit lineCountExceeded();
+        }
+    }
+    else
+    {
+        m_lineLimitWarned = false;
     }
 }
 
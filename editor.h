@@ -14,6 +14,30 @@
 #include <QSyntaxHighlighter>
 #include <QTextCharFormat>
 #include <QRegularExpression>
+#include <QBitArray>
+#include <QTextBlockUserData>
+#include <QElapsedTimer>
+#include <QHelpEvent>
+#include "clexer.h"
+#include "highlightworker.h"
+#include "bracketindex.h"
+#include "textsearch.h"
+#include "decorationmanager.h"
+#include "diagnostics.h"
+
+class QThread;
+class QTimer;
+
+// 文本块缓存的词法分析结果，随块一起由文档管理
+class BlockLexData : public QTextBlockUserData
+{
+public:
+    int inState = -1;  // 分词时的行首状态
+    int outState = -1; // 行末状态，-1表示尚未分词
+    uint textHash = 0; // 分词时的文本哈希
+    bool applied = false; // 当前显示的格式是否与缓存一致
+    QVector<CLexer::Token> tokens;
+};
 
 // 直接在Editor头文件中定义语法高亮器类
 class EditorSyntaxHighlighter : public QSyntaxHighlighter
@@ -22,19 +46,54 @@ class EditorSyntaxHighlighter : public QSyntaxHighlighter
 
 public:
     explicit EditorSyntaxHighlighter(QTextDocument *parent = nullptr);
+    ~EditorSyntaxHighlighter() override;
+
+    // 后台分词模式：超出时间片的块交由工作线程处理
+    void setBackgroundEnabled(bool enabled);
+    bool isBackgroundEnabled() const;
+    // 将[first, last]范围内格式过期的块更新为缓存结果
+    void refreshRange(const QTextBlock &first, const QTextBlock &last);
+    // 分词结果同步写入括号索引
+    void setBracketIndex(BracketIndex *index);
+
+signals:
+    void backgroundPassRequested(int generation, int revision, int blockCount, const QString &snapshot);
+    void backgroundPassFinished();
 
 protected:
     void highlightBlock(const QString &text) override;
 
+private slots:
+    void continueCascade();
+    void startBackgroundPass();
+    void onBackgroundPassFinished(const HighlightResult &result);
+
 private:
-    struct HighlightingRule
-    {
-        QRegularExpression pattern;
-        QTextCharFormat format;
-    };
-    QVector<HighlightingRule> highlightingRules;
-    QRegularExpression commentStartExpression;
-    QRegularExpression commentEndExpression;
+    const QTextCharFormat &formatFor(CLexer::TokenType type) const;
+    void applyTokens(const QVector<CLexer::Token> &tokens);
+    void beginSlice();
+    void deferCascade(const QTextBlock &block);
+    void requestBackgroundPass();
+    void updateBracketIndex(const QString &text, const QVector<CLexer::Token> &tokens);
+
+    // 单轮事件循环内级联重新高亮的时间片（毫秒）
+    static const int kSliceBudgetMs = 8;
+    // 后台模式下在界面线程同步分词的时间片（毫秒）
+    static const int kBackgroundSliceBudgetMs = 2;
+    // 发起后台分词前的合并等待时间（毫秒）
+    static const int kBackgroundDelayMs = 30;
+
+    bool m_backgroundEnabled = false;
+    QThread *m_workerThread = nullptr;
+    HighlightWorker *m_worker = nullptr;
+    QTimer *m_backgroundTimer = nullptr;
+    int m_generation = 0;
+    BracketIndex *m_bracketIndex = nullptr;
+
+    QElapsedTimer m_sliceTimer;
+    bool m_sliceStarted = false;
+    QVector<QTextCursor> m_pendingCascades; // 被推迟的级联起点
+    QTextCharFormat preprocessorFormat;
     QTextCharFormat keywordFormat;
     QTextCharFormat classFormat;
     QTextCharFormat singleLineCommentFormat;
@@ -63,6 +122,19 @@ public:
     void clearAllHighlights();
 
     bool isLineCountValid() const;
+    DecorationManager *decorations() const;
+    // 显示诊断：波浪下划线和行号区标记，位置随后续编辑移动
+    void setDiagnostics(const QVector<Diagnostic> &diagnostics);
+    void clearDiagnostics();
+    void setBackgroundHighlighting(bool enabled);
+
+    // 超过该行数时自动启用后台语法高亮
+    static const int kBackgroundHighlightLines = 5000;
+    void setLineSoftLimit(int limit);
+    int lineSoftLimit() const;
+
+    // 默认行数软限制，超过后仅提示性能可能下降
+    static const int kDefaultLineSoftLimit = 100000;
 
     // 行号显示区域
     class LineNumberArea : public QWidget
@@ -81,11 +153,22 @@ public:
             codeEditor->lineNumberAreaPaintEvent(event);
         }
 
+        bool event(QEvent *event) override
+        {
+            if (event->type() == QEvent::ToolTip)
+            {
+                codeEditor->showDiagnosticToolTip(static_cast<QHelpEvent *>(event));
+                return true;
+            }
+            return QWidget::event(event);
+        }
+
     private:
         Editor *codeEditor;
     };
     int lineNumberAreaWidth();
     void lineNumberAreaPaintEvent(QPaintEvent *event);
+    void showDiagnosticToolTip(QHelpEvent *event);
 
 signals:
     void lineCountExceeded();
@@ -116,6 +199,9 @@ private slots:
     void highlightCurrentLine();
     void updateLineNumberArea(const QRect &rect, int dy);
     void onTextChanged();
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void refreshVisibleHighlight();
+    void refreshVisibleMatches();
     void setTabReplace(bool replace, int spaces = 4);
     void handleComment();
     void highlightMatchingBracket();
@@ -132,32 +218,68 @@ private:
     QAction *highlightSelectionAction{nullptr};
     QAction *clearHighlightsAction{nullptr};
     LineNumberArea *lineNumberArea;
-    QString m_originalText;
-    QSet<int> m_newLineNumbers;
+    QVector<quint64> m_originalLineHashes; // 原始文本每行哈希
+    QVector<quint64> m_lineHashes;         // 当前文档每行哈希，随编辑增量更新
+    QBitArray m_newLineNumbers;            // 新增行标记（按块号索引）
+    bool m_lineDiffDirty = true;
+    int m_lineSoftLimit = kDefaultLineSoftLimit;
+    bool m_lineLimitWarned = false;
     QString m_searchText;
-    QTextDocument::FindFlags m_searchFlags;
-    QVector<QTextCursor> m_matchCursors;
+    QTextDocument::FindFlags m_searchFlags = QTextDocument::FindCaseSensitively;
+    QVector<int> m_matchPositions; // 各匹配项的起始位置（升序），长度均为m_searchText.length()
     int m_currentMatchIndex = -1;
+    int m_matchViewStart = -1;     // 上次生成查找高亮时的可见范围
+    int m_matchViewEnd = -1;
+    // "高亮所选"的结果：独立于查找条件，文档编辑后清除
+    QString m_occurrenceText;
+    QVector<int> m_occurrencePositions; // 各出现位置（升序），长度均为m_occurrenceText.length()
+
+    EditorSyntaxHighlighter *highlighter{nullptr};
 
-    EditorSyntaxHighlighter *highlighter;
+    // 一条诊断在文档中的位置，光标随编辑移动
+    struct DiagnosticMark
+    {
+        QTextCursor cursor;
+        Diagnostic::Severity severity;
+        QString message;
+    };
+    QVector<DiagnosticMark> m_diagnosticMarks;
+    QList<QTextEdit::ExtraSelection> diagnosticSelections() const;
+    QHash<int, Diagnostic::Severity> diagnosticSeverityByBlock() const;
+    int diagnosticMarkerWidth() const;
 
     void setupConnections();
     void updateActionStates();
+    bool askMatchMode(const QString &title, QTextDocument::FindFlags *flags);
     void replaceCurrent(const QString &searchText, const QString &replaceText);
-    void replaceAll(const QString &searchText, const QString &replaceText);
-    QList<QTextEdit::ExtraSelection> baseExtraSelections() const;
-    QList<QTextEdit::ExtraSelection> m_selectionExtraSelections;
+    void replaceAll(const QString &searchText, const QString &replaceText, bool useRegex = false);
+    DecorationManager *m_decorations;
+    QList<QTextEdit::ExtraSelection> currentLineSelections() const;
+    QList<QTextEdit::ExtraSelection> findMatchSelections();
+    QList<QTextEdit::ExtraSelection> occurrenceSelections() const;
+    void clearOccurrences();
+    void updateFindDecorations();
     void highlightAllMatches();
+    void findAllMatches();
+    TextSearch::Options searchOptions() const;
+    void updateMatchesAfterEdit(int position, int charsRemoved, int charsAdded);
+    QTextCursor matchCursor(int index) const;
+    QList<QTextEdit::ExtraSelection> visibleMatchSelections(const QVector<int> &positions, int length,
+                                                            const QTextCharFormat &format) const;
+    void visibleBlockRange(QTextBlock *first, QTextBlock *last) const;
+    void showMatchCount();
+    void showStatusMessage(const QString &message, int timeout = 0);
     QHash<QChar, QChar> m_matchingPairs;
-    int findMatchingBracket(int startPos, QChar bracket, QChar matchBracket, int direction);
+    BracketIndex m_bracketIndex; // 括号嵌套索引，随分词结果增量更新
+    int findMatchingBracket(int bracketPos) const;
+    void rebuildBracketIndex();
     void highlightBracketPair(int pos1, int pos2);
-    void updateBracketHighlight();
     void clearBracketHighlight();
-    QList<QTextEdit::ExtraSelection> m_bracketSelections;
     QString calculateIndentation() const;
     int getIndentationLevel() const;
     void checkAndClearBracketHighlight();//及时清除匹配括号高亮
     void checkLineCountLimit();
+    void rebuildLineHashes();
 };
 
 #endif // EDITOR_H
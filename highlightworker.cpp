@@ -0,0 +1,52 @@
+#include "highlightworker.h"
+
+// 每处理多少个块检查一次任务是否已被取消
+static const int kCancelCheckInterval = 256;
+
+HighlightWorker::HighlightWorker(QObject *parent)
+    : QObject(parent), m_latestGeneration(0)
+{
+}
+
+// 取消旧任务：正在执行的任务会在下一个检查点退出
+void HighlightWorker::cancelBefore(int generation)
+{
+    m_latestGeneration.storeRelease(generation);
+}
+
+// 对文档快照逐块分词，状态在块之间传递
+void HighlightWorker::tokenize(int generation, int revision, int blockCount, const QString &snapshot)
+{
+    if (generation < m_latestGeneration.loadAcquire())
+        return;
+
+    HighlightResult result;
+    result.generation = generation;
+    result.revision = revision;
+    result.blocks.reserve(blockCount);
+
+    int state = CLexer::Normal;
+    int blockStart = 0;
+    while (result.blocks.size() < blockCount && blockStart <= snapshot.length())
+    {
+        if (result.blocks.size() % kCancelCheckInterval == 0 &&
+            generation < m_latestGeneration.loadAcquire())
+            return;
+
+        int blockEnd = snapshot.indexOf(QChar::ParagraphSeparator, blockStart);
+        if (blockEnd < 0)
+            blockEnd = snapshot.length();
+        QString text = snapshot.mid(blockStart, blockEnd - blockStart);
+
+        BlockLexResult block;
+        block.inState = state;
+        block.textHash = qHash(text);
+        block.outState = CLexer::tokenize(text, state, block.tokens);
+        state = block.outState;
+        result.blocks.append(block);
+
+        blockStart = blockEnd + 1;
+    }
+
+    emit finished(result);
+}
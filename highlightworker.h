@@ -0,0 +1,52 @@
+#ifndef HIGHLIGHTWORKER_H
+#define HIGHLIGHTWORKER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QAtomicInt>
+#include <QMetaType>
+#include "clexer.h"
+
+// 单个文本块的分词结果
+struct BlockLexResult
+{
+    int inState = 0;
+    int outState = 0;
+    uint textHash = 0;
+    QVector<CLexer::Token> tokens;
+};
+
+// 一次后台分词的结果，带有生成号和文档修订号
+struct HighlightResult
+{
+    int generation = 0;
+    int revision = 0;
+    QVector<BlockLexResult> blocks;
+};
+
+Q_DECLARE_METATYPE(HighlightResult)
+
+// 后台分词工作对象：运行在独立线程中，对文档快照逐块分词
+class HighlightWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HighlightWorker(QObject *parent = nullptr);
+
+    // 取消生成号小于generation的任务（可在任意线程调用）
+    void cancelBefore(int generation);
+
+public slots:
+    // snapshot为QTextDocument::toRawText()，块之间以段落分隔符分隔
+    void tokenize(int generation, int revision, int blockCount, const QString &snapshot);
+
+signals:
+    void finished(const HighlightResult &result);
+
+private:
+    QAtomicInt m_latestGeneration;
+};
+
+#endif // HIGHLIGHTWORKER_H
@@ -0,0 +1,150 @@
+#include "linediff.h"
+
+// 编辑距离超过该值时放弃精确比较，中间区域整体视为新增
+static const int kMaxEditDistance = 1024;
+
+// 计算单行文本的64位哈希（FNV-1a，逐个UTF-16码元）
+quint64 LineDiff::hashLine(const QChar *data, int length)
+{
+    quint64 hash = Q_UINT64_C(14695981039346656037);
+    for (int i = 0; i < length; ++i)
+    {
+        hash ^= data[i].unicode();
+        hash *= Q_UINT64_C(1099511628211);
+    }
+    return hash;
+}
+
+quint64 LineDiff::hashLine(const QString &line)
+{
+    return hashLine(line.constData(), line.length());
+}
+
+// 将文本按'\n'拆分并计算每行哈希，不产生中间字符串
+QVector<quint64> LineDiff::hashLines(const QString &text)
+{
+    QVector<quint64> hashes;
+    hashes.reserve(text.count('\n') + 1);
+
+    const QChar *data = text.constData();
+    int lineStart = 0;
+    int newline = text.indexOf('\n');
+    while (newline != -1)
+    {
+        hashes.append(hashLine(data + lineStart, newline - lineStart));
+        lineStart = newline + 1;
+        newline = text.indexOf('\n', lineStart);
+    }
+    hashes.append(hashLine(data + lineStart, text.length() - lineStart));
+    return hashes;
+}
+
+// 比较新旧两组行哈希，返回新版本中未匹配的行标记
+QBitArray LineDiff::addedLines(const QVector<quint64> &oldHashes,
+                               const QVector<quint64> &newHashes)
+{
+    QBitArray added(newHashes.size());
+
+    // 裁剪公共前缀和公共后缀，绝大多数编辑只剩下很小的中间区域
+    int prefix = 0;
+    int maxPrefix = qMin(oldHashes.size(), newHashes.size());
+    while (prefix < maxPrefix && oldHashes[prefix] == newHashes[prefix])
+        ++prefix;
+
+    int suffix = 0;
+    int maxSuffix = maxPrefix - prefix;
+    while (suffix < maxSuffix &&
+           oldHashes[oldHashes.size() - 1 - suffix] == newHashes[newHashes.size() - 1 - suffix])
+        ++suffix;
+
+    int n = oldHashes.size() - prefix - suffix;
+    int m = newHashes.size() - prefix - suffix;
+    if (m == 0)
+        return added;
+
+    if (n == 0)
+    {
+        added.fill(true, prefix, prefix + m);
+        return added;
+    }
+
+    myersDiff(oldHashes.constData() + prefix, n, newHashes.constData() + prefix, m, added, prefix);
+    return added;
+}
+
+// Myers O((N+M)D) 差异算法，记录每一步的V数组用于回溯
+void LineDiff::myersDiff(const quint64 *a, int n, const quint64 *b, int m,
+                         QBitArray &added, int offset)
+{
+    const int max = qMin(n + m, kMaxEditDistance);
+    const int base = max + 1;
+    QVector<int> v(2 * max + 3, 0);
+    QVector<QVector<int>> trace;
+
+    int editDistance = -1;
+    for (int d = 0; d <= max && editDistance < 0; ++d)
+    {
+        for (int k = -d; k <= d; k += 2)
+        {
+            int x;
+            if (k == -d || (k != d && v[base + k - 1] < v[base + k + 1]))
+                x = v[base + k + 1];
+            else
+                x = v[base + k - 1] + 1;
+
+            int y = x - k;
+            while (x < n && y < m && a[x] == b[y])
+            {
+                ++x;
+                ++y;
+            }
+            v[base + k] = x;
+
+            if (x >= n && y >= m)
+            {
+                editDistance = d;
+                break;
+            }
+        }
+
+        // 只保存[-d, d]范围内的对角线，总内存为O(D^2)
+        trace.append(v.mid(base - d, 2 * d + 1));
+    }
+
+    // 差异过大：放弃精确比较，中间区域整体标记为新增
+    if (editDistance < 0)
+    {
+        added.fill(true, offset, offset + m);
+        return;
+    }
+
+    // 从终点回溯，向下的移动即为新版本中插入的行
+    int x = n;
+    int y = m;
+    for (int d = editDistance; d > 0; --d)
+    {
+        const QVector<int> &prev = trace[d - 1];
+        int k = x - y;
+        int prevK;
+        if (k == -d || (k != d && prev[k - 1 + d - 1] < prev[k + 1 + d - 1]))
+            prevK = k + 1;
+        else
+            prevK = k - 1;
+
+        int prevX = prev[prevK + d - 1];
+        int prevY = prevX - prevK;
+
+        // 跳过对角线上的匹配行
+        while (x > prevX && y > prevY)
+        {
+            --x;
+            --y;
+        }
+
+        if (prevK == k + 1)
+            added.setBit(offset + prevY);
+
+        x = prevX;
+        y = prevY;
+    }
+}
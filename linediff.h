@@ -0,0 +1,28 @@
+#ifndef LINEDIFF_H
+#define LINEDIFF_H
+
+#include <QBitArray>
+#include <QString>
+#include <QVector>
+
+// 行级差异比较：对行哈希做公共前后缀裁剪，中间部分使用Myers算法
+class LineDiff
+{
+public:
+    // 计算单行文本的64位哈希（FNV-1a）
+    static quint64 hashLine(const QChar *data, int length);
+    static quint64 hashLine(const QString &line);
+
+    // 将文本按'\n'拆分并计算每行哈希
+    static QVector<quint64> hashLines(const QString &text);
+
+    // 比较新旧两组行哈希，返回新版本中未匹配（新增或修改）的行标记
+    static QBitArray addedLines(const QVector<quint64> &oldHashes,
+                                const QVector<quint64> &newHashes);
+
+private:
+    static void myersDiff(const quint64 *a, int n, const quint64 *b, int m,
+                          QBitArray &added, int offset);
+};
+
+#endif // LINEDIFF_H
@@ -2,7 +2,6 @@
 #include "editor.h"
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
-#include <QScrollBar>
 #include <QStatusBar>
 #include <QDebug>
 #include <QSplitter>
@@ -18,6 +17,24 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QTimer>
+#include <QComboBox>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QInputDialog>
+#include <QPlainTextEdit>
+#include <QSettings>
+#include <QSpinBox>
+#include <QThread>
+#include "syntaxchecker.h"
+#include <QMenu>
+#include <QStyle>
+#include <QTextBlock>
+
+// 每个文件保留的基准测试结果数
+static const int kMaxBenchmarkHistory = 20;
+// 设置项：行数软限制
+static const char *const kLineSoftLimitKey = "editor/lineSoftLimit";
 
 // 主窗口构造函数，初始化UI和核心组件
 MainWindow::MainWindow(QWidget *parent)
@@ -36,6 +53,71 @@ MainWindow::MainWindow(QWidget *parent)
     aClear->setObjectName("actionClearHighlights");
     ui->toolBar->addAction(aClear);
 
+    // 行数软限制：超过后提示编辑性能可能下降，可在编辑菜单中修改
+    m_lineSoftLimit = qMax(1, QSettings("TinyIDE", "TinyIDE")
+                                  .value(kLineSoftLimitKey, Editor::kDefaultLineSoftLimit)
+                                  .toInt());
+    QAction *aLineSoftLimit = new QAction(tr("行数软限制..."), this);
+    aLineSoftLimit->setObjectName("actionLineSoftLimit");
+    ui->menuEdit->addSeparator();
+    ui->menuEdit->addAction(aLineSoftLimit);
+    connect(aLineSoftLimit, &QAction::triggered, this, &MainWindow::onLineSoftLimitTriggered);
+
+    // 构建配置：编译器、优化级别和链接方式，随标签页切换
+    ui->toolBar->addSeparator();
+    m_toolchainCombo = new QComboBox(this);
+    m_toolchainCombo->setToolTip(tr("编译器"));
+    const QList<BuildProfile::Toolchain> available = CompilerBackend::availableToolchains();
+    for (int i = 0; i < BuildProfile::ToolchainCount; ++i)
+    {
+        BuildProfile::Toolchain toolchain = BuildProfile::Toolchain(i);
+        QString name = BuildProfile::toolchainName(toolchain);
+        if (!available.contains(toolchain))
+            name += tr("（未安装）");
+        m_toolchainCombo->addItem(name, i);
+    }
+    ui->toolBar->addWidget(m_toolchainCombo);
+
+    m_profileCombo = new QComboBox(this);
+    m_profileCombo->setToolTip(tr("优化级别"));
+    for (int i = 0; i < BuildProfile::OptimizationCount; ++i)
+        m_profileCombo->addItem(BuildProfile::optimizationName(BuildProfile::Optimization(i)), i);
+    ui->toolBar->addWidget(m_profileCombo);
+
+    m_staticLinkAction = new QAction(tr("静态链接"), this);
+    m_staticLinkAction->setObjectName("actionStaticLink");
+    m_staticLinkAction->setCheckable(true);
+    m_staticLinkAction->setToolTip(tr("静态链接C库：程序不依赖运行库，但链接明显更慢"));
+    ui->toolBar->addAction(m_staticLinkAction);
+
+    // 快速运行：优先用tcc编译，成功后立即运行
+    QAction *aQuickRun = new QAction(tr("快速运行"), this);
+    aQuickRun->setObjectName("actionQuickRun");
+    aQuickRun->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_R));
+    aQuickRun->setToolTip(tr("用编译最快的编译器（tcc）编译并立即运行"));
+    ui->toolBar->addAction(aQuickRun);
+    connect(aQuickRun, &QAction::triggered, this, &MainWindow::onQuickRunTriggered);
+
+    // 基准测试：按当前构建配置编译后重复运行，统计耗时分布
+    QAction *aBenchmark = new QAction(tr("基准测试"), this);
+    aBenchmark->setObjectName("actionBenchmark");
+    aBenchmark->setToolTip(tr("多次运行程序（可预热、固定标准输入、绑定CPU），统计耗时的最小值、中位数、平均值、P95和标准差"));
+    ui->toolBar->addAction(aBenchmark);
+    connect(aBenchmark, &QAction::triggered, this, &MainWindow::onBenchmarkTriggered);
+
+    // 运行方式：交互运行及时显示输出；基准运行保持C运行库默认的全缓冲，测量性能时不受干扰
+    m_runModeCombo = new QComboBox(this);
+    m_runModeCombo->setToolTip(tr("运行方式：交互运行在伪终端上按行显示输出；基准运行经管道全缓冲输出，适合测量性能"));
+    m_runModeCombo->addItem(tr("交互运行"), int(Compiler::InteractiveRun));
+    m_runModeCombo->addItem(tr("基准运行"), int(Compiler::BenchmarkRun));
+    ui->toolBar->addWidget(m_runModeCombo);
+
+    QAction *aRunLimits = new QAction(tr("运行限制..."), this);
+    aRunLimits->setObjectName("actionRunLimits");
+    aRunLimits->setToolTip(tr("设置运行时间、CPU时间、内存和输出量上限，防止死循环或内存泄漏拖垮系统"));
+    ui->toolBar->addAction(aRunLimits);
+    connect(aRunLimits, &QAction::triggered, this, &MainWindow::onRunLimitsTriggered);
+
     ui->actionFind->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_F));
     ui->actionReplace->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_H));
 
@@ -78,38 +160,38 @@ MainWindow::MainWindow(QWidget *parent)
         "}";
     // 创建第一个标签页
     Editor *editor = new Editor();
+    editor->setLineSoftLimit(m_lineSoftLimit);
     editor->setPlainText(initialCode);
     editor->setOriginalText(initialCode);
 
     // 确保应用默认字体
     editor->setEditorFont(defaultFont);
 
-    // 连接编辑器内容变化信号
-    connect(editor, &QPlainTextEdit::textChanged,
-            this, &MainWindow::onEditorTextChanged);
-
     // 添加到标签页
-    m_tabWidget->addTab(editor, "未命名");
-
-    // 存储标签页信息
-    FileTabInfo info;
-    info.editor = editor;
-    info.filePath = "";
-    info.isSaved = true;
-    info.displayName = "未命名";
-    m_tabInfos.append(info);
+    addEditorTab(editor, "", "未命名");
 
     // 设置当前标签页索引
     m_currentTabIndex = 0;
-
-    // 设置输出框为只读模式
-    ui->outputTextEdit->setReadOnly(true);
-
-    // 禁用输出框的撤销/重做功能
-    ui->outputTextEdit->setUndoRedoEnabled(false);
-
-    // 禁用输出框的拖放功能
-    ui->outputTextEdit->setAcceptDrops(false);
+    syncBuildProfileControls();
+    connect(m_profileCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onBuildProfileChanged);
+    connect(m_staticLinkAction, &QAction::toggled, this, &MainWindow::onBuildProfileChanged);
+    connect(m_toolchainCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onBuildProfileChanged);
+
+    // 输出窗口只读，只绘制可见行；超过保留上限的早期输出转存到磁盘
+    ui->outputConsole->setFont(defaultFont);
+
+    // 问题列表：编译诊断逐条加入，单击跳转，右键应用修复
+    m_problemsList = new QListWidget(this);
+    m_problemsList->setMaximumHeight(140);
+    m_problemsList->setContextMenuPolicy(Qt::CustomContextMenu);
+    m_problemsList->hide();
+    connect(m_problemsList, &QListWidget::itemClicked, this, [this](QListWidgetItem *item)
+            { jumpToProblem(item->data(Qt::UserRole).toInt()); });
+    connect(m_problemsList, &QListWidget::itemActivated, this, [this](QListWidgetItem *item)
+            { jumpToProblem(item->data(Qt::UserRole).toInt()); });
+    connect(m_problemsList, &QWidget::customContextMenuRequested, this, &MainWindow::showProblemsMenu);
 
     // 创建程序输入区域
     QWidget *inputWidget = new QWidget(this);
@@ -136,7 +218,8 @@ MainWindow::MainWindow(QWidget *parent)
     QVBoxLayout *mainLayout = new QVBoxLayout(centralWidget);
     mainLayout->setContentsMargins(10, 10, 10, 10);
     mainLayout->addWidget(m_tabWidget);
-    mainLayout->addWidget(ui->outputTextEdit);
+    mainLayout->addWidget(ui->outputConsole);
+    mainLayout->addWidget(m_problemsList);
     mainLayout->addWidget(inputWidget);
 
     // 设置中央部件
@@ -144,6 +227,8 @@ MainWindow::MainWindow(QWidget *parent)
 
     // 初始化编译器对象
     m_compiler = new Compiler(this);
+    connect(m_runModeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]()
+            { m_compiler->setRunMode(Compiler::RunMode(m_runModeCombo->currentData().toInt())); });
 
     // 连接编译器信号
     connect(m_compiler, &Compiler::compileFinished,
@@ -152,13 +237,49 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_compiler, &Compiler::runFinished,
             this, &MainWindow::onRunFinished);
 
+    connect(m_compiler, &Compiler::benchmarkFinished,
+            this, &MainWindow::onBenchmarkFinished);
+
+    connect(m_compiler, &Compiler::benchmarkProgress, this, [this](int completed, int total)
+            { statusBar()->showMessage(QString("基准测试中... %1/%2").arg(completed).arg(total)); });
+
     connect(m_compiler, &Compiler::runOutput,
             this, &MainWindow::handleRunOutput);
 
+    connect(m_compiler, &Compiler::diagnosticsReceived,
+            this, &MainWindow::onDiagnosticsReceived);
+
+    // 后台语法检查：停止输入后用gcc检查，诊断显示在编辑器中
+    m_syntaxChecker = new SyntaxChecker(this);
+    m_syntaxChecker->setExtraArguments(m_compiler->preludeArguments());
+    connect(m_syntaxChecker, &SyntaxChecker::diagnosticsReady, this,
+            [](Editor *editor, const QVector<Diagnostic> &diagnostics) { editor->setDiagnostics(diagnostics); });
+    for (const FileTabInfo &tab : m_tabInfos)
+        m_syntaxChecker->addEditor(tab.editor, tab.displayName);
+
+    // 静态分析：对当前文件按需运行gcc -fanalyzer
+    QAction *aAnalyze = new QAction(tr("静态分析"), this);
+    aAnalyze->setObjectName("actionAnalyze");
+    aAnalyze->setToolTip(tr("使用gcc -fanalyzer检查当前文件"));
+    ui->toolBar->addAction(aAnalyze);
+    connect(aAnalyze, &QAction::triggered, this, [this]()
+            {
+        Editor *e = currentEditor();
+        if (!e)
+            return;
+        m_syntaxChecker->checkNow(e, true);
+        statusBar()->showMessage("静态分析中...", 3000); });
+
     // 设置初始窗口标题
     setWindowTitle("TinyIDE - 未命名");
     // 全局查找/替换由 MainWindow 转发到当前编辑器
     connect(ui->actionFind, &QAction::triggered, this, [this]() {
+        // 焦点在输出窗口时在输出中查找
+        if (ui->outputConsole->hasFocus())
+        {
+            ui->outputConsole->showFindDialog();
+            return;
+        }
         Editor *e = currentEditor();
         if (e) e->handleFind();
     });
@@ -259,6 +380,96 @@ void MainWindow::onTabChanged(int index)
 
     // 更新窗口标题
     setWindowTitle("TinyIDE - " + info.displayName + (info.isSaved ? "" : "*"));
+    syncBuildProfileControls();
+}
+
+// 用当前标签页的构建配置刷新工具栏控件
+void MainWindow::syncBuildProfileControls()
+{
+    if (m_currentTabIndex < 0 || m_currentTabIndex >= m_tabInfos.size())
+        return;
+
+    const BuildProfile &profile = m_tabInfos[m_currentTabIndex].profile;
+    const QSignalBlocker comboBlocker(m_profileCombo);
+    const QSignalBlocker actionBlocker(m_staticLinkAction);
+    const QSignalBlocker toolchainBlocker(m_toolchainCombo);
+    m_toolchainCombo->setCurrentIndex(m_toolchainCombo->findData(int(profile.toolchain)));
+    m_profileCombo->setCurrentIndex(m_profileCombo->findData(int(profile.optimization)));
+    m_staticLinkAction->setChecked(profile.linkage == BuildProfile::StaticLinkage);
+}
+
+// 工具栏修改构建配置后保存到当前标签页
+void MainWindow::onBuildProfileChanged()
+{
+    if (m_currentTabIndex < 0 || m_currentTabIndex >= m_tabInfos.size())
+        return;
+
+    BuildProfile &profile = m_tabInfos[m_currentTabIndex].profile;
+    profile.optimization = BuildProfile::Optimization(m_profileCombo->currentData().toInt());
+    profile.toolchain = BuildProfile::Toolchain(m_toolchainCombo->currentData().toInt());
+    profile.linkage = m_staticLinkAction->isChecked() ? BuildProfile::StaticLinkage
+                                                      : BuildProfile::DynamicLinkage;
+    statusBar()->showMessage("构建配置: " + profile.description(), 3000);
+}
+
+// 修改行数软限制：保存到设置，并应用到所有打开的编辑器
+void MainWindow::onLineSoftLimitTriggered()
+{
+    bool ok = false;
+    int limit = QInputDialog::getInt(this, tr("行数软限制"), tr("超过该行数时提示编辑性能可能下降:"),
+                                     m_lineSoftLimit, 1, 100000000, 1000, &ok);
+    if (!ok)
+        return;
+
+    m_lineSoftLimit = limit;
+    QSettings("TinyIDE", "TinyIDE").setValue(kLineSoftLimitKey, limit);
+    for (const FileTabInfo &info : m_tabInfos)
+        info.editor->setLineSoftLimit(limit);
+    statusBar()->showMessage(QString("行数软限制: %1行").arg(limit), 3000);
+}
+
+// 运行限制对话框：各项为0时不限制
+void MainWindow::onRunLimitsTriggered()
+{
+    RunLimits limits = m_compiler->runLimits();
+    const int megabyte = 1024 * 1024;
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("运行限制"));
+    QFormLayout *layout = new QFormLayout(&dialog);
+
+    auto addSpinBox = [&](const QString &label, qint64 value, int maximum, const QString &suffix)
+    {
+        QSpinBox *spinBox = new QSpinBox(&dialog);
+        spinBox->setRange(0, maximum);
+        spinBox->setValue(int(value));
+        spinBox->setSuffix(suffix);
+        spinBox->setSpecialValueText(tr("不限制"));
+        layout->addRow(label, spinBox);
+        return spinBox;
+    };
+    QSpinBox *wallTime = addSpinBox(tr("运行时间:"), limits.wallTimeSeconds, 24 * 3600, " s");
+    QSpinBox *cpuTime = addSpinBox(tr("CPU时间:"), limits.cpuTimeSeconds, 24 * 3600, " s");
+    QSpinBox *memory = addSpinBox(tr("内存:"), limits.memoryBytes / megabyte, 1024 * 1024, " MB");
+    QSpinBox *output = addSpinBox(tr("输出:"), limits.outputBytes / megabyte, 1024 * 1024, " MB");
+#ifndef Q_OS_UNIX
+    cpuTime->setEnabled(false);
+    memory->setEnabled(false);
+#endif
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    layout->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    limits.wallTimeSeconds = wallTime->value();
+    limits.cpuTimeSeconds = cpuTime->value();
+    limits.memoryBytes = qint64(memory->value()) * megabyte;
+    limits.outputBytes = qint64(output->value()) * megabyte;
+    m_compiler->setRunLimits(limits);
+    statusBar()->showMessage("运行限制: " + limits.description(), 3000);
 }
 
 // 标签页关闭请求处理
@@ -345,17 +556,60 @@ void MainWindow::updateTabTitle(int index)
 // 编译操作处理
 void MainWindow::on_actionCompile_triggered()
 {
-    Editor *editor = currentEditor();
-    if (!editor)
+    if (!currentEditor())
+        return;
+
+    m_runAfterCompile = false;
+    m_benchmarkAfterCompile = false;
+    startCompile(m_tabInfos[m_currentTabIndex].profile);
+}
+
+// 快速运行：用tcc（没有时用gcc）以调试、动态链接方式编译，成功后直接运行
+void MainWindow::onQuickRunTriggered()
+{
+    if (!currentEditor())
         return;
 
+    // 支持时直接在内存中编译运行，不经过编译器进程和可执行文件
+    if (Compiler::isInMemoryRunSupported())
+    {
+        Editor *editor = currentEditor();
+        ui->outputConsole->appendPlainText("\n--- 快速运行（libtcc） ---");
+        statusBar()->showMessage("运行中...");
+        clearProblems();
+        m_compileEditor = editor;
+        m_runAfterCompile = false;
+        m_benchmarkAfterCompile = false;
+        if (m_compiler->runInMemory(editor->getCodeText(), m_tabInfos[m_currentTabIndex].displayName))
+            return;
+    }
+
+    BuildProfile profile;
+    profile.toolchain = CompilerBackend::quickRunToolchain();
+    profile.optimization = BuildProfile::Debug;
+    profile.linkage = BuildProfile::DynamicLinkage;
+    m_runAfterCompile = true;
+    m_benchmarkAfterCompile = false;
+    startCompile(profile);
+}
+
+// 用指定构建配置编译当前标签页
+void MainWindow::startCompile(const BuildProfile &profile)
+{
+    Editor *editor = currentEditor();
+
     // 添加编译分隔线
-    ui->outputTextEdit->appendPlainText("\n--- 开始编译 ---");
+    ui->outputConsole->appendPlainText("\n--- 开始编译 ---");
     statusBar()->showMessage("编译中...");
 
-    // 获取并编译当前代码
+    // 获取并编译当前代码，诊断中的位置使用标签页上的文件名
+    const FileTabInfo &info = m_tabInfos[m_currentTabIndex];
+    ui->outputConsole->appendPlainText("构建配置: " + profile.description());
     QString code = editor->getCodeText();
-    m_compiler->compile(code);
+    clearProblems();
+    m_compileEditor = editor;
+    m_compiler->setBuildProfile(profile);
+    m_compiler->compile(code, info.displayName);
 }
 
 // 获取当前活动的编辑器
@@ -375,7 +629,7 @@ void MainWindow::on_actionRun_triggered()
     if (!editor)
         return;
 
-    ui->outputTextEdit->appendPlainText("\n--- 运行程序 ---");
+    ui->outputConsole->appendPlainText("\n--- 运行程序 ---");
     statusBar()->showMessage("运行中...");
     m_compiler->runProgram();
 }
@@ -385,32 +639,295 @@ void MainWindow::onCompileFinished(bool success, const QString &output)
 {
     // 更新状态栏和输出框
     statusBar()->showMessage(success ? "编译成功" : "编译失败");
-    ui->outputTextEdit->appendPlainText(output);
+    ui->outputConsole->appendPlainText(output);
+
+    // 编译诊断同时显示在编辑器中（没有诊断时保留后台检查的结果）
+    if (m_compileEditor && !m_compileDiagnostics.isEmpty())
+        m_compileEditor->setDiagnostics(m_compileDiagnostics);
 
     // 自动滚动到底部
-    QScrollBar *scrollbar = ui->outputTextEdit->verticalScrollBar();
-    scrollbar->setValue(scrollbar->maximum());
+    ui->outputConsole->scrollToBottom();
+
+    // 快速运行：编译成功后直接运行
+    if (m_runAfterCompile)
+    {
+        m_runAfterCompile = false;
+        if (success)
+            on_actionRun_triggered();
+    }
+
+    if (m_benchmarkAfterCompile)
+    {
+        m_benchmarkAfterCompile = false;
+        if (success)
+        {
+            ui->outputConsole->appendPlainText("\n--- 基准测试 ---");
+            statusBar()->showMessage("基准测试中...");
+            ui->actionStop->setEnabled(true);
+            m_compiler->runBenchmark(m_benchmarkOptions);
+        }
+    }
+}
+
+// 基准测试：设置运行次数、预热次数、绑定的CPU和标准输入，然后按本标签页的构建配置编译
+void MainWindow::onBenchmarkTriggered()
+{
+    Editor *editor = currentEditor();
+    if (!editor)
+        return;
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("基准测试"));
+    QFormLayout *layout = new QFormLayout(&dialog);
+
+    QSpinBox *runs = new QSpinBox(&dialog);
+    runs->setRange(1, 1000);
+    runs->setValue(m_benchmarkOptions.runs);
+    layout->addRow(tr("运行次数:"), runs);
+
+    QSpinBox *warmupRuns = new QSpinBox(&dialog);
+    warmupRuns->setRange(0, 100);
+    warmupRuns->setValue(m_benchmarkOptions.warmupRuns);
+    layout->addRow(tr("预热次数:"), warmupRuns);
+
+    QSpinBox *cpu = new QSpinBox(&dialog);
+    cpu->setRange(-1, QThread::idealThreadCount() - 1);
+    cpu->setValue(m_benchmarkOptions.cpu);
+    cpu->setSpecialValueText(tr("不绑定"));
+#ifndef Q_OS_LINUX
+    cpu->setEnabled(false);
+#endif
+    layout->addRow(tr("绑定CPU:"), cpu);
+
+    QPlainTextEdit *input = new QPlainTextEdit(&dialog);
+    input->setPlainText(QString::fromLocal8Bit(m_benchmarkOptions.input));
+    input->setPlaceholderText(tr("每次运行相同的标准输入，为空时程序读到文件结束"));
+    layout->addRow(tr("标准输入:"), input);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    layout->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    m_benchmarkOptions.runs = runs->value();
+    m_benchmarkOptions.warmupRuns = warmupRuns->value();
+    m_benchmarkOptions.cpu = cpu->value();
+    m_benchmarkOptions.input = input->toPlainText().toLocal8Bit();
+
+    m_benchmarkEditor = editor;
+    m_runAfterCompile = false;
+    m_benchmarkAfterCompile = true;
+    startCompile(m_tabInfos[m_currentTabIndex].profile);
+}
+
+// 基准测试结束：结果保存到所测文件的标签页，与该文件上一次的结果比较
+void MainWindow::onBenchmarkFinished(bool success, const BenchmarkResult &result, const QString &message)
+{
+    ui->actionStop->setEnabled(false);
+    ui->outputConsole->appendPlainText(message);
+    if (!success)
+    {
+        statusBar()->showMessage("基准测试失败");
+        ui->outputConsole->scrollToBottom();
+        return;
+    }
+
+    QString summary = QString("基准测试完成  中位耗时 %1 ms").arg(result.wallMs.median, 0, 'f', 3);
+    for (FileTabInfo &info : m_tabInfos)
+    {
+        if (!m_benchmarkEditor || info.editor != m_benchmarkEditor)
+            continue;
+
+        if (!info.benchmarks.isEmpty())
+        {
+            QString comparison = result.compareTo(info.benchmarks.last());
+            ui->outputConsole->appendPlainText(comparison);
+            summary += "  " + comparison;
+        }
+        info.benchmarks.append(result);
+        if (info.benchmarks.size() > kMaxBenchmarkHistory)
+            info.benchmarks.removeFirst();
+        break;
+    }
+    statusBar()->showMessage(summary);
+    ui->outputConsole->scrollToBottom();
+}
+
+// 文档中第line行第column个字节（均从1开始）对应的位置
+static int documentPosition(QTextDocument *document, int line, int column)
+{
+    QTextBlock block = document->findBlockByNumber(qMax(0, line - 1));
+    if (!block.isValid())
+        block = document->lastBlock();
+    return block.position() + Diagnostic::columnIndex(block.text(), column);
+}
+
+// 清空问题列表
+void MainWindow::clearProblems()
+{
+    m_problems.clear();
+    m_compileDiagnostics.clear();
+    m_problemsList->clear();
+    m_problemsList->hide();
+}
+
+// 编译诊断到达：转换为光标位置后加入问题列表
+void MainWindow::onDiagnosticsReceived(const QVector<Diagnostic> &diagnostics)
+{
+    m_compileDiagnostics += diagnostics;
+
+    // 只有映射回编辑器文件名的诊断可以跳转
+    Editor *editor = m_compileEditor;
+    QString fileName;
+    for (const FileTabInfo &tab : m_tabInfos)
+    {
+        if (tab.editor == editor)
+            fileName = tab.displayName;
+    }
+
+    for (const Diagnostic &diagnostic : diagnostics)
+    {
+        ProblemEntry entry;
+        entry.diagnostic = diagnostic;
+        if (editor && diagnostic.file == fileName && diagnostic.line > 0)
+        {
+            QTextDocument *document = editor->document();
+            entry.editor = editor;
+            entry.cursor = QTextCursor(document);
+            entry.cursor.setPosition(documentPosition(document, diagnostic.line, diagnostic.column));
+            for (const Diagnostic::FixIt &fixIt : diagnostic.fixIts)
+            {
+                QTextCursor range(document);
+                range.setPosition(documentPosition(document, fixIt.line, fixIt.column));
+                range.setPosition(documentPosition(document, fixIt.endLine, fixIt.endColumn),
+                                  QTextCursor::KeepAnchor);
+                entry.fixIts.append(range);
+            }
+        }
+
+        QString text = diagnostic.toString();
+        QStyle::StandardPixmap icon = QStyle::SP_MessageBoxCritical;
+        if (diagnostic.severity == Diagnostic::Warning)
+            icon = QStyle::SP_MessageBoxWarning;
+        else if (diagnostic.severity == Diagnostic::Note)
+        {
+            icon = QStyle::SP_MessageBoxInformation;
+            text = "    " + text;
+        }
+        if (!entry.fixIts.isEmpty())
+            text += "  [可快速修复]";
+
+        QListWidgetItem *item = new QListWidgetItem(style()->standardIcon(icon), text);
+        item->setData(Qt::UserRole, m_problems.size());
+        m_problemsList->addItem(item);
+        m_problems.append(entry);
+    }
+    m_problemsList->setVisible(!m_problems.isEmpty());
+}
+
+// 跳转到问题所在位置
+void MainWindow::jumpToProblem(int index)
+{
+    if (index < 0 || index >= m_problems.size() || !m_problems[index].editor)
+        return;
+
+    const ProblemEntry &entry = m_problems[index];
+    m_tabWidget->setCurrentWidget(entry.editor);
+    entry.editor->setTextCursor(QTextCursor(entry.cursor));
+    entry.editor->ensureCursorVisible();
+    entry.editor->setFocus();
+}
+
+// 应用问题附带的全部修复，作为一次撤销操作
+void MainWindow::applyFixIts(int index)
+{
+    if (index < 0 || index >= m_problems.size() || !m_problems[index].editor)
+        return;
+
+    ProblemEntry &entry = m_problems[index];
+    if (entry.fixIts.isEmpty())
+        return;
+
+    QTextCursor block(entry.editor->document());
+    block.beginEditBlock();
+    for (int i = 0; i < entry.fixIts.size(); ++i)
+        entry.fixIts[i].insertText(entry.diagnostic.fixIts[i].replacement);
+    block.endEditBlock();
+
+    entry.fixIts.clear();
+    if (QListWidgetItem *item = m_problemsList->item(index))
+        item->setText(entry.diagnostic.toString() + "  [已修复]");
+    jumpToProblem(index);
+}
+
+// 问题列表右键菜单
+void MainWindow::showProblemsMenu(const QPoint &pos)
+{
+    QListWidgetItem *item = m_problemsList->itemAt(pos);
+    if (!item)
+        return;
+
+    const int index = item->data(Qt::UserRole).toInt();
+    QMenu menu(this);
+    QAction *jumpAction = menu.addAction(tr("跳转到位置"));
+    QAction *fixAction = menu.addAction(tr("应用修复"));
+    jumpAction->setEnabled(m_problems[index].editor != nullptr);
+    fixAction->setEnabled(m_problems[index].editor != nullptr && !m_problems[index].fixIts.isEmpty());
+
+    QAction *chosen = menu.exec(m_problemsList->viewport()->mapToGlobal(pos));
+    if (chosen == jumpAction)
+        jumpToProblem(index);
+    else if (chosen == fixAction)
+        applyFixIts(index);
 }
 
 // 运行完成处理
 void MainWindow::onRunFinished(bool success, const QString &output)
 {
-    statusBar()->showMessage(success ? "运行完成" : "运行失败");
-    ui->outputTextEdit->appendPlainText(output);
+    QString usage = m_compiler->lastRunUsage().toString();
+    statusBar()->showMessage(QString(success ? "运行完成" : "运行失败") + "  " + usage);
+    ui->outputConsole->appendPlainText(output);
 
     // 自动滚动到底部
-    QScrollBar *scrollbar = ui->outputTextEdit->verticalScrollBar();
-    scrollbar->setValue(scrollbar->maximum());
+    ui->outputConsole->scrollToBottom();
 }
 
 // 运行时输出处理
 void MainWindow::handleRunOutput(const QString &output)
 {
-    ui->outputTextEdit->appendPlainText(output);
+    // 输出按批到达，不一定以换行结束，直接接在末尾而不是另起一段
+    // 原来停在底部时自动跟随，向上翻看时不打断
+    ui->outputConsole->insertText(output);
+}
 
-    // 自动滚动到底部
-    QScrollBar *scrollbar = ui->outputTextEdit->verticalScrollBar();
-    scrollbar->setValue(scrollbar->maximum());
+// 把编辑器加入标签页并连接各标签页共用的信号，返回标签页索引
+// 构造函数、新建和打开都经由这里，每个标签页的行为一致；语法检查器创建前加入的标签页由构造函数统一登记
+int MainWindow::addEditorTab(Editor *editor, const QString &filePath, const QString &displayName)
+{
+    // 连接编辑器内容变化信号
+    connect(editor, &QPlainTextEdit::textChanged,
+            this, &MainWindow::onEditorTextChanged);
+
+    // 连接行数超限信号
+    connect(editor, &Editor::lineCountExceeded, this, [this, editor]() {
+        statusBar()->showMessage(QString("文本行数已超过%1行，编辑性能可能下降")
+                                     .arg(editor->lineSoftLimit()), 5000);
+    });
+
+    int index = m_tabWidget->addTab(editor, displayName);
+
+    // 存储标签页信息
+    FileTabInfo info;
+    info.editor = editor;
+    info.filePath = filePath;
+    info.isSaved = true;
+    info.displayName = displayName;
+    m_tabInfos.append(info);
+    if (m_syntaxChecker)
+        m_syntaxChecker->addEditor(editor, displayName);
+    return index;
 }
 
 // 新建文件处理
@@ -422,11 +939,7 @@ void MainWindow::on_actionNew_triggered()
 
     // 创建新编辑器
     Editor *editor = new Editor();
-
-    // 连接行数超限信号
-    connect(editor, &Editor::lineCountExceeded, this, [this]() {
-        QMessageBox::warning(this, "警告", "文本行数不得超过2000行！");
-    });
+    editor->setLineSoftLimit(m_lineSoftLimit);
 
     // 设置初始示例代码
     QString initialCode =
@@ -441,34 +954,8 @@ void MainWindow::on_actionNew_triggered()
     // 确保应用默认字体
     editor->setEditorFont(defaultFont);
 
-    // 连接编辑器内容变化信号
-    connect(editor, &QPlainTextEdit::textChanged, this, [this, editor]()
-            {
-        // 直接调用处理函数，但传递正确的编辑器
-        for (int i = 0; i < m_tabInfos.size(); ++i) {
-            if (m_tabInfos[i].editor == editor) {
-                FileTabInfo &info = m_tabInfos[i];
-                if (info.isSaved) {
-                    info.isSaved = false;
-                    updateTabTitle(i);
-                    if (i == m_currentTabIndex) {
-                        setWindowTitle("TinyIDE - " + info.displayName + "*");
-                    }
-                }
-                break;
-            }
-        } });
-
     // 添加到标签页
-    int newIndex = m_tabWidget->addTab(editor, "未命名");
-
-    // 存储标签页信息
-    FileTabInfo info;
-    info.editor = editor;
-    info.filePath = "";
-    info.isSaved = true;
-    info.displayName = "未命名";
-    m_tabInfos.append(info);
+    int newIndex = addEditorTab(editor, "", "未命名");
 
     // 延迟调用，确保编辑器能够找到主窗口
     //QTimer::singleShot(100, this, [editor]()
@@ -506,47 +993,44 @@ void MainWindow::on_actionOpen_triggered()
 
     // 创建新编辑器
     Editor *editor = new Editor();
+    editor->setLineSoftLimit(m_lineSoftLimit);
 
     // 确保新编辑器使用默认字体
     editor->setEditorFont(defaultFont);
 
     QTextStream in(&file);
     QString content = in.readAll();
-    // 检查行数
-    if (content.count('\n') + 1 > 2000) {
-        QMessageBox::critical(this, "错误", "文件行数超过2000行，无法打开！");
-        file.close();
-        delete editor; // 清理已创建的编辑器
-        return;
-    }
     file.close();
 
+    // 超过行数软限制时让用户确认，而不是直接拒绝打开
+    int lineCount = content.count('\n') + 1;
+    if (lineCount > editor->lineSoftLimit())
+    {
+        QMessageBox::StandardButton choice = QMessageBox::question(
+            this, "提示",
+            QString("文件共%1行，超过%2行，编辑性能可能下降。是否继续打开？")
+                .arg(lineCount)
+                .arg(editor->lineSoftLimit()));
+        if (choice != QMessageBox::Yes)
+        {
+            delete editor; // 清理已创建的编辑器
+            return;
+        }
+    }
+
+    // 大文件在设置内容前启用后台语法高亮，避免打开时阻塞界面
+    if (lineCount > Editor::kBackgroundHighlightLines)
+        editor->setBackgroundHighlighting(true);
+
     // 设置编辑器内容
     editor->setPlainText(content);
     editor->setOriginalText(content);
 
-    // 连接行数超限信号
-    connect(editor, &Editor::lineCountExceeded, this, [this]() {
-        QMessageBox::warning(this, "警告", "文本行数不得超过2000行！");
-    });
-
-    // 连接编辑器内容变化信号
-    connect(editor, &QPlainTextEdit::textChanged,
-            this, &MainWindow::onEditorTextChanged);
-
     // 获取文件名
     QString fileName = QFileInfo(filePath).fileName();
 
     // 添加到标签页
-    int newIndex = m_tabWidget->addTab(editor, fileName);
-
-    // 存储标签页信息
-    FileTabInfo info;
-    info.editor = editor;
-    info.filePath = filePath;
-    info.isSaved = true;
-    info.displayName = fileName;
-    m_tabInfos.append(info);
+    int newIndex = addEditorTab(editor, filePath, fileName);
 
     // 延迟调用，确保编辑器能够找到主窗口
     //QTimer::singleShot(100, this, [editor]()
@@ -623,6 +1107,7 @@ bool MainWindow::on_actionSaveAs_triggered()
     // 更新路径并保存
     info.filePath = filePath;
     info.displayName = QFileInfo(filePath).fileName();
+    m_syntaxChecker->setFileName(info.editor, info.displayName);
     bool result = on_actionSave_triggered();
 
     // 更新标签页标题
@@ -733,7 +1218,7 @@ void MainWindow::onSendInput()
         m_compiler->sendInput(input);
 
         // 在输出框中显示输入内容
-        ui->outputTextEdit->appendPlainText("> " + input);
+        ui->outputConsole->appendPlainText("> " + input);
 
         // 清空输入框
         m_inputLineEdit->clear();
@@ -8,6 +8,20 @@
 #include <QString>
 #include <QMessageBox>
 #include <QListWidget>
+#include <QComboBox>
+#include <QPointer>
+#include <QTextCursor>
+
+class SyntaxChecker;
+
+// 问题列表中的一项：位置和修复范围在诊断到达时转换为光标，之后随编辑移动，跳转时无需再查找
+struct ProblemEntry
+{
+    QPointer<Editor> editor;   // 诊断不属于打开的文件时为空
+    QTextCursor cursor;
+    Diagnostic diagnostic;
+    QVector<QTextCursor> fixIts; // 每个修复要替换的范围，与diagnostic.fixIts一一对应
+};
 
 namespace Ui
 {
@@ -20,6 +34,8 @@ struct FileTabInfo
     QString filePath;
     bool isSaved;
     QString displayName;
+    BuildProfile profile; // 本标签页的构建配置
+    QVector<BenchmarkResult> benchmarks; // 本文件的基准测试历史，用于比较修改前后的性能
 };
 
 class MainWindow : public QMainWindow
@@ -34,6 +50,7 @@ private:
     Ui::MainWindow *ui;
     Editor *m_editor;
     Compiler *m_compiler;
+    SyntaxChecker *m_syntaxChecker = nullptr;
     QString m_currentFilePath;
     QWidget *m_inputWidget;
     QTabWidget *m_tabWidget;
@@ -41,12 +58,35 @@ private:
     bool m_isSaved;
     QVector<FileTabInfo> m_tabInfos;
     int m_currentTabIndex;
+    int m_lineSoftLimit = Editor::kDefaultLineSoftLimit; // 新建和打开的编辑器使用的行数软限制，保存在设置中
     Editor *currentEditor() const;
     QFont getDefaultEditorFont() const;
+    int addEditorTab(Editor *editor, const QString &filePath, const QString &displayName);
+    QComboBox *m_toolchainCombo; // 编译器选择
+    QComboBox *m_profileCombo;   // 优化级别选择
+    QAction *m_staticLinkAction; // 静态链接开关
+    QComboBox *m_runModeCombo;   // 运行方式选择
+    void syncBuildProfileControls();
+
+    // 问题列表
+    QListWidget *m_problemsList;
+    QVector<ProblemEntry> m_problems;
+    QPointer<Editor> m_compileEditor;        // 正在编译的编辑器
+    bool m_runAfterCompile = false;          // 快速运行：编译成功后直接运行
+    bool m_benchmarkAfterCompile = false;    // 基准测试：编译成功后开始测试
+    QPointer<Editor> m_benchmarkEditor;      // 正在测试的文件，结果保存到其标签页
+    BenchmarkOptions m_benchmarkOptions;     // 上一次使用的基准测试设置
+    void startCompile(const BuildProfile &profile);
+    QVector<Diagnostic> m_compileDiagnostics; // 本次编译的全部诊断
+    void clearProblems();
+    void jumpToProblem(int index);
+    void applyFixIts(int index);
+    void showProblemsMenu(const QPoint &pos);
 
 private slots:
     void on_actionCompile_triggered();
     void on_actionRun_triggered();
+    void onQuickRunTriggered();
     void onCompileFinished(bool success, const QString &output);
     void onRunFinished(bool success, const QString &output);
     void handleRunOutput(const QString &output);
@@ -62,6 +102,12 @@ private slots:
     void onTabChanged(int index);
     void onTabCloseRequested(int index);
     void updateTabTitle(int index);
+    void onBuildProfileChanged();
+    void onRunLimitsTriggered();
+    void onLineSoftLimitTriggered();
+    void onBenchmarkTriggered();
+    void onBenchmarkFinished(bool success, const BenchmarkResult &result, const QString &message);
+    void onDiagnosticsReceived(const QVector<Diagnostic> &diagnostics);
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,217 @@
+#include "outputcollector.h"
+#include <QTextCodec>
+#include <QTextDecoder>
+#include <QTimer>
+#include <cstring>
+
+namespace
+{
+    // 按大小选择单位
+    QString formatBytes(double bytes)
+    {
+        if (bytes < 1024)
+            return QString("%1 B").arg(qint64(bytes));
+        if (bytes < 1024 * 1024)
+            return QString("%1 KB").arg(bytes / 1024, 0, 'f', 1);
+        return QString("%1 MB").arg(bytes / (1024 * 1024), 0, 'f', 1);
+    }
+}
+
+double OutputCollector::Stats::bytesPerSecond() const
+{
+    return elapsedMs > 0 ? bytes * 1000.0 / elapsedMs : 0.0;
+}
+
+double OutputCollector::Stats::linesPerSecond() const
+{
+    return elapsedMs > 0 ? lines * 1000.0 / elapsedMs : 0.0;
+}
+
+QString OutputCollector::Stats::toString() const
+{
+    QString text = QString("输出 %1，%2 行（%3/s，%4 行/s）")
+                       .arg(formatBytes(bytes))
+                       .arg(lines)
+                       .arg(formatBytes(bytesPerSecond()))
+                       .arg(qint64(linesPerSecond()));
+    if (droppedBytes > 0)
+        text += QString("，%1 未显示").arg(formatBytes(droppedBytes));
+    return text;
+}
+
+OutputCollector::OutputCollector(QObject *parent, int capacity)
+    : QObject(parent),
+      m_ring(qMax(capacity, 1), '\0'),
+      m_capacity(m_ring.size()),
+      m_timer(new QTimer(this)),
+      m_decoder(QTextCodec::codecForLocale()->makeDecoder())
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(kFlushIntervalMs);
+    connect(m_timer, &QTimer::timeout, this, &OutputCollector::onTimeout);
+}
+
+OutputCollector::~OutputCollector()
+{
+}
+
+void OutputCollector::start()
+{
+    m_timer->stop();
+    m_head = 0;
+    m_size = 0;
+    m_pendingDropped = 0;
+    if (m_ring.size() != m_capacity)
+        m_ring = QByteArray(m_capacity, '\0');
+    m_pausable = true;
+    setPaused(false);
+    m_stats = Stats();
+    m_decoder.reset(QTextCodec::codecForLocale()->makeDecoder());
+    m_clock.start();
+    m_running = true;
+}
+
+void OutputCollector::setPausable(bool pausable)
+{
+    m_pausable = pausable;
+}
+
+// 写入环形缓冲区，只做复制和计数，解码留到定时器中；达到容量时请求暂停读取，
+// 请求生效前到达的数据（最多一批读取）扩容存放，不丢弃。无法暂停的来源不扩容，
+// 空间不足时覆盖最旧的字节
+void OutputCollector::append(const char *data, qint64 size)
+{
+    if (size <= 0)
+        return;
+
+    m_stats.bytes += size;
+    for (const char *p = data, *end = data + size; (p = static_cast<const char *>(memchr(p, '\n', size_t(end - p)))); ++p)
+        ++m_stats.lines;
+
+    if (!m_pausable && m_size + size > m_ring.size())
+    {
+        const int capacity = m_ring.size();
+        if (size >= capacity)
+        {
+            // 新数据本身就放不下：只保留其末尾部分
+            m_pendingDropped += size - capacity;
+            data += size - capacity;
+            size = capacity;
+            drop(m_size);
+        }
+        else
+        {
+            drop(int(m_size + size - capacity));
+        }
+    }
+    else if (m_size + size > m_ring.size())
+    {
+        grow(int(m_size + size));
+    }
+
+    const int capacity = m_ring.size();
+    char *ring = m_ring.data();
+    int tail = (m_head + m_size) % capacity;
+    int first = qMin(int(size), capacity - tail);
+    memcpy(ring + tail, data, size_t(first));
+    memcpy(ring, data + first, size_t(size - first));
+    m_size += int(size);
+
+    if (m_pausable && m_size >= m_capacity)
+        setPaused(true);
+    if (!m_timer->isActive())
+        m_timer->start();
+}
+
+// 丢弃最旧的bytes个未发出字节，下次发出时插入提示
+void OutputCollector::drop(int bytes)
+{
+    m_head = (m_head + bytes) % m_ring.size();
+    m_size -= bytes;
+    m_pendingDropped += bytes;
+}
+
+// 按顺序取出未发出的数据放入更大的缓冲区
+void OutputCollector::grow(int minimumSize)
+{
+    QByteArray ring(qMax(minimumSize, m_ring.size() * 2), '\0');
+    const int first = qMin(m_size, m_ring.size() - m_head);
+    memcpy(ring.data(), m_ring.constData() + m_head, size_t(first));
+    memcpy(ring.data() + first, m_ring.constData(), size_t(m_size - first));
+    m_ring = ring;
+    m_head = 0;
+}
+
+void OutputCollector::setPaused(bool paused)
+{
+    if (m_paused == paused)
+        return;
+    m_paused = paused;
+    emit backpressureChanged(paused);
+}
+
+void OutputCollector::append(const QByteArray &data)
+{
+    append(data.constData(), data.size());
+}
+
+void OutputCollector::finish()
+{
+    m_timer->stop();
+    flush(m_size);
+    if (m_running)
+    {
+        m_stats.elapsedMs = m_clock.elapsed();
+        m_running = false;
+    }
+}
+
+OutputCollector::Stats OutputCollector::stats() const
+{
+    Stats result = m_stats;
+    if (m_running)
+        result.elapsedMs = m_clock.elapsed();
+    return result;
+}
+
+// 发出最多maxBytes字节；此前有丢弃时先插入提示，解码器重置以免从半个字符开始解码；
+// 缓冲区降到容量一半以下时恢复读取
+void OutputCollector::flush(int maxBytes)
+{
+    QString text;
+    if (m_pendingDropped > 0)
+    {
+        m_stats.droppedBytes += m_pendingDropped;
+        text = QString("\n[输出过快，已省略 %1 字节]\n").arg(m_pendingDropped);
+        m_pendingDropped = 0;
+        m_decoder.reset(QTextCodec::codecForLocale()->makeDecoder());
+    }
+
+    const int capacity = m_ring.size();
+    const int n = qMin(m_size, maxBytes);
+    const int first = qMin(n, capacity - m_head);
+    text += m_decoder->toUnicode(m_ring.constData() + m_head, first);
+    if (n > first)
+        text += m_decoder->toUnicode(m_ring.constData(), n - first);
+    m_head = (m_head + n) % capacity;
+    m_size -= n;
+
+    if (!text.isEmpty())
+        emit outputReady(text);
+    if (m_size <= m_capacity / 2)
+        setPaused(false);
+}
+
+// 分块发出，直到发完或用完本次的时间预算；界面处理得越快，每次发出的越多
+void OutputCollector::onTimeout()
+{
+    QElapsedTimer budget;
+    budget.start();
+    do
+    {
+        flush(kFlushChunkBytes);
+    } while (m_size > 0 && budget.elapsed() < kFlushBudgetMs);
+
+    if (m_size > 0)
+        m_timer->start();
+}
@@ -0,0 +1,83 @@
+#ifndef OUTPUTCOLLECTOR_H
+#define OUTPUTCOLLECTOR_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include <QString>
+
+class QTextDecoder;
+class QTimer;
+
+// 运行输出收集：子进程输出的原始字节先放入环形缓冲区，由定时器合并后统一解码发出，
+// 界面最多每kFlushIntervalMs毫秒更新一次，每次在kFlushBudgetMs毫秒内尽量多发；
+// 输出速度超过界面消化能力时不丢弃任何字节，而是在缓冲区写满时通知输出来源暂停读取
+// （子进程随之阻塞在写入上），发出一半后再恢复。无法暂停的来源改为丢弃最旧的字节并插入提示
+class OutputCollector : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 两次发出之间的最小间隔（毫秒），约一帧
+    static const int kFlushIntervalMs = 16;
+    // 环形缓冲区默认容量（字节），达到时请求暂停读取；暂停前已读出的数据临时扩容存放
+    static const int kDefaultCapacity = 1024 * 1024;
+    // 每次定时发出的时间预算（毫秒），包括界面处理输出的时间，其余时间留给事件循环
+    static const int kFlushBudgetMs = 4;
+    // 时间预算内每块发出的字节数，每块发出后检查一次耗时
+    static const int kFlushChunkBytes = 64 * 1024;
+
+    // 吞吐量统计
+    struct Stats
+    {
+        qint64 bytes = 0;
+        qint64 lines = 0;
+        qint64 droppedBytes = 0; // 无法暂停的来源溢出时未显示的字节数
+        qint64 elapsedMs = 0;
+
+        double bytesPerSecond() const;
+        double linesPerSecond() const;
+        QString toString() const;
+    };
+
+    explicit OutputCollector(QObject *parent = nullptr, int capacity = kDefaultCapacity);
+    ~OutputCollector() override;
+
+    // 开始新一次运行：清空缓冲区和统计，重新计时；输出来源默认可以暂停
+    void start();
+    // 输出来源能否响应backpressureChanged暂停读取；不能时缓冲区不扩容，写满后丢弃最旧的字节
+    void setPausable(bool pausable);
+    void append(const char *data, qint64 size);
+    void append(const QByteArray &data);
+    // 运行结束：立即发出缓冲区中的全部内容并停止计时
+    void finish();
+    Stats stats() const;
+
+signals:
+    void outputReady(const QString &text);
+    // 缓冲区写满时paused为true，输出来源应停止读取，直到再次发出false
+    void backpressureChanged(bool paused);
+
+private:
+    void flush(int maxBytes);
+    void drop(int bytes);
+    void onTimeout();
+    void grow(int minimumSize);
+    void setPaused(bool paused);
+
+    QByteArray m_ring;
+    int m_capacity;  // 正常容量，m_ring可能因暂停前已读出的数据临时更大
+    int m_head = 0; // 最旧未发出字节的位置
+    int m_size = 0; // 未发出的字节数
+    qint64 m_pendingDropped = 0; // 上次发出后丢弃的字节数
+    bool m_pausable = true;
+    bool m_paused = false;
+    bool m_running = false;
+    Stats m_stats;
+    QElapsedTimer m_clock;
+    QTimer *m_timer;
+    QScopedPointer<QTextDecoder> m_decoder;
+};
+
+#endif // OUTPUTCOLLECTOR_H
@@ -0,0 +1,703 @@
+#include "outputconsole.h"
+#include <QApplication>
+#include <QClipboard>
+#include <QContextMenuEvent>
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
+#include <QFontDatabase>
+#include <QInputDialog>
+#include <QKeyEvent>
+#include <QMenu>
+#include <QMessageBox>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTemporaryFile>
+#include <algorithm>
+
+// 文本左侧留白（像素）
+static const int kMargin = 4;
+// 保存时每次从转存文件读取的字节数
+static const int kCopyBlockSize = 1024 * 1024;
+
+OutputConsole::OutputConsole(QWidget *parent)
+    : QAbstractScrollArea(parent)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    clear();
+}
+
+OutputConsole::~OutputConsole()
+{
+}
+
+void OutputConsole::appendPlainText(const QString &text)
+{
+    if (m_lineCount > 1 || !lineRef(0).isEmpty())
+    {
+        newLine();
+    }
+    insertText(text);
+}
+
+// 追加输出：原来停在底部时保持跟随，否则保持当前看到的内容不动
+void OutputConsole::insertText(const QString &text)
+{
+    QScrollBar *bar = verticalScrollBar();
+    const bool atBottom = bar->value() >= bar->maximum();
+    const int oldValue = bar->value();
+
+    const QChar *data = text.constData();
+    const int length = text.size();
+    int pos = 0;
+    for (int i = 0; i <= length; ++i)
+    {
+        // '\r'直接丢弃，Windows程序输出的"\r\n"按一次换行处理
+        if (i == length || data[i] == QLatin1Char('\n') || data[i] == QLatin1Char('\r'))
+        {
+            appendToLastLine(data + pos, i - pos);
+            if (i < length && data[i] == QLatin1Char('\n'))
+                newLine();
+            pos = i + 1;
+        }
+    }
+
+    const int shift = enforceRetention();
+    updateScrollBars();
+    if (atBottom)
+        scrollToBottom();
+    else if (shift != 0)
+        bar->setValue(oldValue - shift);
+    viewport()->update();
+}
+
+void OutputConsole::clear()
+{
+    m_chunks.clear();
+    m_chunks.append(Chunk());
+    m_chunks.last().starts.append(0);
+    m_lineCount = 1;
+    m_maxLineLength = 0;
+    m_bytes = sizeof(int);
+
+    if (m_spillFile)
+    {
+        m_spillFile->resize(0);
+        m_spillFile->seek(0);
+    }
+    m_spilledBytes = 0;
+    m_spilledLines = 0;
+    m_discardedLines = 0;
+
+    m_anchor = m_cursor = Position();
+    updateScrollBars();
+    viewport()->update();
+}
+
+void OutputConsole::setRetentionLimit(qint64 bytes)
+{
+    m_retentionLimit = bytes;
+    enforceRetention();
+    updateScrollBars();
+    viewport()->update();
+}
+
+qint64 OutputConsole::retentionLimit() const
+{
+    return m_retentionLimit;
+}
+
+void OutputConsole::setSpillLimit(qint64 bytes)
+{
+    m_spillLimit = bytes;
+}
+
+qint64 OutputConsole::spillLimit() const
+{
+    return m_spillLimit;
+}
+
+int OutputConsole::lineCount() const
+{
+    return m_lineCount;
+}
+
+qint64 OutputConsole::spilledLineCount() const
+{
+    return m_spilledLines;
+}
+
+qint64 OutputConsole::discardedLineCount() const
+{
+    return m_discardedLines;
+}
+
+// 追加到最后一行，超过单行长度上限时换到新行
+void OutputConsole::appendToLastLine(const QChar *data, int length)
+{
+    while (length > 0)
+    {
+        Chunk &chunk = m_chunks.last();
+        const int current = chunk.text.size() - chunk.starts.last();
+        const int room = kMaxLineLength - current;
+        if (room <= 0)
+        {
+            newLine();
+            continue;
+        }
+
+        const int n = qMin(room, length);
+        chunk.text.append(data, n);
+        m_bytes += n * qint64(sizeof(QChar));
+        m_maxLineLength = qMax(m_maxLineLength, current + n);
+        data += n;
+        length -= n;
+    }
+}
+
+// 结束最后一行；当前块已满时开始新块，并释放已满块多余的容量
+void OutputConsole::newLine()
+{
+    Chunk &chunk = m_chunks.last();
+    chunk.text.append(QLatin1Char('\n'));
+    m_bytes += sizeof(QChar) + sizeof(int);
+    if (chunk.starts.size() < kChunkLines)
+    {
+        chunk.starts.append(chunk.text.size());
+    }
+    else
+    {
+        chunk.text.squeeze();
+        m_chunks.append(Chunk());
+        m_chunks.last().starts.append(0);
+    }
+    ++m_lineCount;
+}
+
+// 超过保留上限时把最早的块转存到磁盘，返回移出内存的行数（含新出现的提示行）
+int OutputConsole::enforceRetention()
+{
+    const int oldHeader = headerLines();
+    int removed = 0;
+    while (m_bytes > m_retentionLimit && m_chunks.size() > 1)
+    {
+        const Chunk chunk = m_chunks.takeFirst();
+        spill(chunk);
+        m_bytes -= chunk.text.size() * qint64(sizeof(QChar)) + chunk.starts.size() * qint64(sizeof(int));
+        m_lineCount -= chunk.starts.size();
+        removed += chunk.starts.size();
+    }
+    if (removed == 0)
+        return 0;
+
+    // 选区随之上移，被移出的部分不再保留
+    m_anchor.line -= removed;
+    m_cursor.line -= removed;
+    if (m_anchor.line < 0 || m_cursor.line < 0)
+        m_anchor = m_cursor = Position();
+    return removed - (headerLines() - oldHeader);
+}
+
+// 写入转存文件，超过上限或文件无法创建时丢弃
+void OutputConsole::spill(const Chunk &chunk)
+{
+    if (!m_spillFile)
+    {
+        m_spillFile = new QTemporaryFile(QDir::temp().absoluteFilePath("TinyIDE_output_XXXXXX.txt"), this);
+        if (!m_spillFile->open())
+        {
+            delete m_spillFile;
+            m_spillFile = nullptr;
+        }
+    }
+
+    const QByteArray data = chunk.text.toUtf8();
+    if (!m_spillFile || m_spilledBytes + data.size() > m_spillLimit ||
+        m_spillFile->write(data) != data.size())
+    {
+        m_discardedLines += chunk.starts.size();
+        return;
+    }
+    m_spilledBytes += data.size();
+    m_spilledLines += chunk.starts.size();
+}
+
+// 内存中第line行的内容（不含换行）
+QStringRef OutputConsole::lineRef(int line) const
+{
+    const int chunkIndex = line / kChunkLines;
+    const int index = line % kChunkLines;
+    const Chunk &chunk = m_chunks.at(chunkIndex);
+    const int start = chunk.starts.at(index);
+    int end;
+    if (index + 1 < chunk.starts.size())
+        end = chunk.starts.at(index + 1) - 1;
+    else
+        end = chunk.text.size() - (chunkIndex + 1 < m_chunks.size() ? 1 : 0);
+    return chunk.text.midRef(start, end - start);
+}
+
+OutputConsole::Position OutputConsole::positionForOffset(int chunkIndex, int offset) const
+{
+    const QVector<int> &starts = m_chunks.at(chunkIndex).starts;
+    const int index = int(std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin()) - 1;
+    Position position;
+    position.line = chunkIndex * kChunkLines + index;
+    position.column = offset - starts.at(index);
+    return position;
+}
+
+// 位置在所在块文本中的偏移
+int OutputConsole::offsetForPosition(const Position &position) const
+{
+    return m_chunks.at(position.line / kChunkLines).starts.at(position.line % kChunkLines) + position.column;
+}
+
+// 有输出被转存或丢弃时，在最上方显示一行提示
+int OutputConsole::headerLines() const
+{
+    return m_spilledLines + m_discardedLines > 0 ? 1 : 0;
+}
+
+QString OutputConsole::headerText() const
+{
+    QString text = tr("[更早的 %1 行输出已转存到磁盘，可通过右键菜单“保存全部输出”导出")
+                       .arg(m_spilledLines + m_discardedLines);
+    if (m_discardedLines > 0)
+        text += tr("，其中 %1 行超出转存上限已丢弃").arg(m_discardedLines);
+    return text + "]";
+}
+
+void OutputConsole::updateScrollBars()
+{
+    const QFontMetrics metrics = fontMetrics();
+    const int page = qMax(1, viewport()->height() / metrics.height());
+    const int rows = m_lineCount + headerLines();
+    verticalScrollBar()->setPageStep(page);
+    verticalScrollBar()->setRange(0, qMax(0, rows - page));
+
+    const int width = m_maxLineLength * metrics.averageCharWidth() + 2 * kMargin;
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setRange(0, qMax(0, width - viewport()->width()));
+}
+
+void OutputConsole::scrollToBottom()
+{
+    verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+}
+
+// 只绘制可见的行，选中部分用高亮色重绘
+void OutputConsole::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+    QPainter painter(viewport());
+    const QFontMetrics metrics = fontMetrics();
+    const int lineHeight = metrics.height();
+    const int header = headerLines();
+    const int rows = m_lineCount + header;
+    const int x = kMargin - horizontalScrollBar()->value();
+
+    Position selStart, selEnd;
+    selectionRange(&selStart, &selEnd);
+    const bool selected = !(selStart == selEnd);
+
+    int y = 0;
+    for (int row = verticalScrollBar()->value(); row < rows && y < viewport()->height(); ++row, y += lineHeight)
+    {
+        if (row < header)
+        {
+            painter.setPen(palette().color(QPalette::Disabled, QPalette::Text));
+            painter.drawText(x, y + metrics.ascent(), headerText());
+            continue;
+        }
+
+        const int line = row - header;
+        const QStringRef ref = lineRef(line);
+        const QString text = QString::fromRawData(ref.unicode(), ref.size());
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(x, y + metrics.ascent(), text);
+
+        if (!selected || line < selStart.line || line > selEnd.line)
+            continue;
+
+        const int from = line == selStart.line ? selStart.column : 0;
+        const int to = line == selEnd.line ? selEnd.column : text.size();
+        int left = xForColumn(ref, from);
+        int right = xForColumn(ref, to);
+        // 选区跨过行尾时多画一个空格宽度表示换行
+        if (line < selEnd.line)
+            right += metrics.horizontalAdvance(QLatin1Char(' '));
+        const QRect rect(left, y, right - left, lineHeight);
+
+        painter.save();
+        painter.fillRect(rect, palette().brush(QPalette::Highlight));
+        painter.setClipRect(rect);
+        painter.setPen(palette().color(QPalette::HighlightedText));
+        painter.drawText(x, y + metrics.ascent(), text);
+        painter.restore();
+    }
+}
+
+void OutputConsole::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    const bool atBottom = verticalScrollBar()->value() >= verticalScrollBar()->maximum();
+    updateScrollBars();
+    if (atBottom)
+        scrollToBottom();
+}
+
+void OutputConsole::scrollContentsBy(int dx, int dy)
+{
+    Q_UNUSED(dx)
+    Q_UNUSED(dy)
+    viewport()->update();
+}
+
+void OutputConsole::changeEvent(QEvent *event)
+{
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange)
+    {
+        updateScrollBars();
+        viewport()->update();
+    }
+}
+
+// 视口坐标对应的行列，点在文本之外时取最近的位置
+OutputConsole::Position OutputConsole::positionAt(const QPoint &point) const
+{
+    const QFontMetrics metrics = fontMetrics();
+    const int row = verticalScrollBar()->value() + qMax(0, point.y()) / metrics.height();
+
+    Position position;
+    position.line = qBound(0, row - headerLines(), m_lineCount - 1);
+    if (row < headerLines())
+        return position;
+
+    const QStringRef line = lineRef(position.line);
+    const int target = point.x() - (kMargin - horizontalScrollBar()->value());
+    int advance = 0;
+    while (position.column < line.size())
+    {
+        const int width = metrics.horizontalAdvance(line.at(position.column));
+        if (advance + width / 2 > target)
+            break;
+        advance += width;
+        ++position.column;
+    }
+    return position;
+}
+
+int OutputConsole::xForColumn(const QStringRef &line, int column) const
+{
+    return kMargin - horizontalScrollBar()->value() +
+           fontMetrics().horizontalAdvance(QString::fromRawData(line.unicode(), column));
+}
+
+bool OutputConsole::hasSelection() const
+{
+    return !(m_anchor == m_cursor);
+}
+
+void OutputConsole::selectionRange(Position *start, Position *end) const
+{
+    *start = qMin(m_anchor, m_cursor);
+    *end = qMax(m_anchor, m_cursor);
+}
+
+QString OutputConsole::selectedText() const
+{
+    Position start, end;
+    selectionRange(&start, &end);
+    if (start == end)
+        return QString();
+
+    QString text;
+    for (int line = start.line; line <= end.line; ++line)
+    {
+        const QStringRef ref = lineRef(line);
+        const int from = line == start.line ? start.column : 0;
+        const int to = line == end.line ? end.column : ref.size();
+        text += ref.mid(from, to - from);
+        if (line < end.line)
+            text += QLatin1Char('\n');
+    }
+    return text;
+}
+
+void OutputConsole::selectRange(const Position &start, const Position &end)
+{
+    m_anchor = start;
+    m_cursor = end;
+    viewport()->update();
+}
+
+void OutputConsole::copy()
+{
+    if (hasSelection())
+        QApplication::clipboard()->setText(selectedText());
+}
+
+void OutputConsole::selectAll()
+{
+    Position end;
+    end.line = m_lineCount - 1;
+    end.column = lineRef(end.line).size();
+    selectRange(Position(), end);
+}
+
+// 滚动到能看到position的位置，需要时让该行居中
+void OutputConsole::ensureVisible(const Position &position)
+{
+    QScrollBar *bar = verticalScrollBar();
+    const int row = position.line + headerLines();
+    if (row < bar->value() || row >= bar->value() + bar->pageStep())
+        bar->setValue(row - bar->pageStep() / 2);
+
+    const int x = xForColumn(lineRef(position.line), position.column) + horizontalScrollBar()->value();
+    QScrollBar *hbar = horizontalScrollBar();
+    if (x < hbar->value() || x > hbar->value() + viewport()->width() - kMargin)
+        hbar->setValue(x - viewport()->width() / 2);
+}
+
+// 在各块的连续文本上用TextSearch查找，不需要逐行构造字符串
+bool OutputConsole::find(const QString &pattern, TextSearch::Options options, bool backward)
+{
+    if (pattern.isEmpty())
+        return false;
+
+    const TextSearch search(pattern, options);
+    Position start, end;
+    selectionRange(&start, &end);
+    const Position from = backward ? start : end;
+    const int fromChunk = from.line / kChunkLines;
+    const int fromOffset = offsetForPosition(from);
+    const int count = m_chunks.size();
+
+    // 多查一轮回到起始块，覆盖起点另一侧的部分
+    for (int pass = 0; pass <= count; ++pass)
+    {
+        const int chunkIndex = backward ? (fromChunk - pass % count + count) % count
+                                        : (fromChunk + pass) % count;
+        const QString &text = m_chunks.at(chunkIndex).text;
+        int pos = -1;
+        if (!backward)
+        {
+            pos = search.indexIn(text, pass == 0 ? fromOffset : 0);
+        }
+        else
+        {
+            const QVector<int> matches = search.findAll(text);
+            for (int i = matches.size() - 1; i >= 0 && pos < 0; --i)
+            {
+                if (pass != 0 || matches.at(i) < fromOffset)
+                    pos = matches.at(i);
+            }
+        }
+
+        if (pos >= 0)
+        {
+            const Position matchStart = positionForOffset(chunkIndex, pos);
+            const Position matchEnd = positionForOffset(chunkIndex, pos + pattern.size());
+            selectRange(matchStart, matchEnd);
+            ensureVisible(matchStart);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 与编辑器的查找对话框相同：先输入内容，再选择匹配方式
+void OutputConsole::showFindDialog()
+{
+    bool ok;
+    QString searchText = QInputDialog::getText(this, tr("在输出中查找"), tr("请输入要查找的内容:"),
+                                               QLineEdit::Normal,
+                                               hasSelection() ? selectedText() : m_searchText, &ok);
+    if (!ok || searchText.isEmpty())
+        return;
+
+    QStringList modes;
+    modes << tr("区分大小写") << tr("不区分大小写")
+          << tr("全字匹配（区分大小写）") << tr("全字匹配（不区分大小写）");
+    int current = (m_searchOptions & TextSearch::CaseInsensitive ? 1 : 0) +
+                  (m_searchOptions & TextSearch::WholeWord ? 2 : 0);
+    QString mode = QInputDialog::getItem(this, tr("在输出中查找"), tr("请选择匹配方式:"),
+                                         modes, current, false, &ok);
+    if (!ok)
+        return;
+
+    int modeIndex = modes.indexOf(mode);
+    m_searchText = searchText;
+    m_searchOptions = TextSearch::NoOptions;
+    if (modeIndex % 2 == 1)
+        m_searchOptions |= TextSearch::CaseInsensitive;
+    if (modeIndex >= 2)
+        m_searchOptions |= TextSearch::WholeWord;
+
+    // 从头开始查找
+    m_anchor = m_cursor = Position();
+    findNext();
+}
+
+void OutputConsole::findNext()
+{
+    if (m_searchText.isEmpty())
+    {
+        showFindDialog();
+        return;
+    }
+    if (!find(m_searchText, m_searchOptions))
+        QMessageBox::information(this, tr("查找"), tr("输出中未找到\"%1\"").arg(m_searchText));
+}
+
+void OutputConsole::findPrevious()
+{
+    if (m_searchText.isEmpty())
+    {
+        showFindDialog();
+        return;
+    }
+    if (!find(m_searchText, m_searchOptions, true))
+        QMessageBox::information(this, tr("查找"), tr("输出中未找到\"%1\"").arg(m_searchText));
+}
+
+// 先写出磁盘上的部分，再逐块写出内存中的部分
+bool OutputConsole::saveFullOutput(const QString &fileName, QString *errorMessage)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        if (errorMessage)
+            *errorMessage = file.errorString();
+        return false;
+    }
+
+    bool ok = true;
+    if (m_spillFile)
+    {
+        m_spillFile->flush();
+        m_spillFile->seek(0);
+        QByteArray block;
+        while (ok && !(block = m_spillFile->read(kCopyBlockSize)).isEmpty())
+            ok = file.write(block) == block.size();
+        m_spillFile->seek(m_spillFile->size());
+    }
+    if (ok && m_discardedLines > 0)
+    {
+        QByteArray note = tr("[此处有 %1 行输出超出转存上限，已丢弃]\n").arg(m_discardedLines).toUtf8();
+        ok = file.write(note) == note.size();
+    }
+    for (int i = 0; ok && i < m_chunks.size(); ++i)
+    {
+        QByteArray data = m_chunks.at(i).text.toUtf8();
+        ok = file.write(data) == data.size();
+    }
+
+    if (!ok && errorMessage)
+        *errorMessage = file.errorString();
+    return ok;
+}
+
+void OutputConsole::showSaveDialog()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("保存全部输出"), QDir::homePath(),
+                                                    tr("文本文件 (*.txt);;所有文件 (*)"));
+    if (fileName.isEmpty())
+        return;
+
+    QString error;
+    if (!saveFullOutput(fileName, &error))
+        QMessageBox::warning(this, tr("保存失败"), tr("无法保存输出: %1").arg(error));
+}
+
+void OutputConsole::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton)
+    {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+
+    const Position position = positionAt(event->pos());
+    if (!(event->modifiers() & Qt::ShiftModifier))
+        m_anchor = position;
+    m_cursor = position;
+    m_selecting = true;
+    viewport()->update();
+}
+
+// 拖动选择，拖出视口时滚动
+void OutputConsole::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!m_selecting || !(event->buttons() & Qt::LeftButton))
+        return;
+
+    if (event->pos().y() < 0)
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+    else if (event->pos().y() > viewport()->height())
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+
+    m_cursor = positionAt(event->pos());
+    viewport()->update();
+}
+
+// 双击选中单词
+void OutputConsole::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton)
+        return;
+
+    const Position position = positionAt(event->pos());
+    const QStringRef line = lineRef(position.line);
+    auto isWordChar = [](QChar c)
+    { return c.isLetterOrNumber() || c == QLatin1Char('_'); };
+
+    Position start = position, end = position;
+    while (start.column > 0 && isWordChar(line.at(start.column - 1)))
+        --start.column;
+    while (end.column < line.size() && isWordChar(line.at(end.column)))
+        ++end.column;
+    selectRange(start, end);
+    m_selecting = false;
+}
+
+void OutputConsole::keyPressEvent(QKeyEvent *event)
+{
+    if (event->matches(QKeySequence::Copy))
+        copy();
+    else if (event->matches(QKeySequence::SelectAll))
+        selectAll();
+    else if (event->matches(QKeySequence::Find))
+        showFindDialog();
+    else if (event->matches(QKeySequence::FindNext))
+        findNext();
+    else if (event->matches(QKeySequence::FindPrevious))
+        findPrevious();
+    else if (event->matches(QKeySequence::MoveToStartOfDocument))
+        verticalScrollBar()->setValue(0);
+    else if (event->matches(QKeySequence::MoveToEndOfDocument))
+        scrollToBottom();
+    else
+        QAbstractScrollArea::keyPressEvent(event);
+}
+
+void OutputConsole::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    QAction *copyAction = menu.addAction(tr("复制"), this, &OutputConsole::copy, QKeySequence::Copy);
+    copyAction->setEnabled(hasSelection());
+    menu.addAction(tr("全选"), this, &OutputConsole::selectAll, QKeySequence::SelectAll);
+    menu.addSeparator();
+    menu.addAction(tr("查找..."), this, &OutputConsole::showFindDialog);
+    QAction *nextAction = menu.addAction(tr("查找下一个"), this, &OutputConsole::findNext, QKeySequence::FindNext);
+    nextAction->setEnabled(!m_searchText.isEmpty());
+    menu.addSeparator();
+    menu.addAction(tr("保存全部输出..."), this, &OutputConsole::showSaveDialog);
+    menu.addAction(tr("清空"), this, &OutputConsole::clear);
+    menu.exec(event->globalPos());
+}
@@ -0,0 +1,139 @@
+#ifndef OUTPUTCONSOLE_H
+#define OUTPUTCONSOLE_H
+
+#include <QAbstractScrollArea>
+#include <QList>
+#include <QString>
+#include <QStringRef>
+#include <QVector>
+#include "textsearch.h"
+
+class QTemporaryFile;
+
+// 输出窗口：只读的行存储按固定行数分块，绘制时只排版可见行；
+// 内存中的内容超过保留上限时，最早的块写入磁盘临时文件后释放，"保存全部输出"时与内存中的部分依次写出
+class OutputConsole : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    // 每块的行数，除最后一块外都是满的，按行号可直接定位到块
+    static const int kChunkLines = 1024;
+    // 单行最大长度，超出部分接到下一行显示
+    static const int kMaxLineLength = 4096;
+    // 默认在内存中保留的输出大小（字节）
+    static const qint64 kDefaultRetentionBytes = 32 * 1024 * 1024;
+    // 默认的磁盘转存上限（字节）
+    static const qint64 kDefaultSpillLimitBytes = 1024LL * 1024 * 1024;
+
+    explicit OutputConsole(QWidget *parent = nullptr);
+    ~OutputConsole() override;
+
+    // 另起一行追加，与QPlainTextEdit::appendPlainText一致
+    void appendPlainText(const QString &text);
+    // 接在最后一行末尾追加，text中的换行开始新行
+    void insertText(const QString &text);
+    void clear();
+
+    // 内存中保留的输出上限，超出时最早的内容转存到磁盘
+    void setRetentionLimit(qint64 bytes);
+    qint64 retentionLimit() const;
+    // 磁盘转存上限，超出后更早的输出直接丢弃
+    void setSpillLimit(qint64 bytes);
+    qint64 spillLimit() const;
+
+    // 内存中的行数
+    int lineCount() const;
+    // 已转存到磁盘和已丢弃的行数
+    qint64 spilledLineCount() const;
+    qint64 discardedLineCount() const;
+
+    // 从当前选区之后（backward为true时之前）查找并选中，到头后从另一端继续
+    bool find(const QString &pattern, TextSearch::Options options = TextSearch::NoOptions,
+              bool backward = false);
+    // 把转存文件和内存中的输出写入fileName，逐块写出，不拼接成完整的字符串
+    bool saveFullOutput(const QString &fileName, QString *errorMessage = nullptr);
+
+    bool hasSelection() const;
+    QString selectedText() const;
+
+public slots:
+    void copy();
+    void selectAll();
+    void scrollToBottom();
+    void showFindDialog();
+    void findNext();
+    void findPrevious();
+    void showSaveDialog();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void changeEvent(QEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+
+private:
+    // 一块输出：各行以'\n'分隔（最后一块的最后一行尚未结束），starts为每行的起始位置
+    struct Chunk
+    {
+        QString text;
+        QVector<int> starts;
+    };
+
+    // 内存中的行号和列号
+    struct Position
+    {
+        int line = 0;
+        int column = 0;
+
+        bool operator==(const Position &other) const { return line == other.line && column == other.column; }
+        bool operator<(const Position &other) const
+        {
+            return line < other.line || (line == other.line && column < other.column);
+        }
+    };
+
+    void appendToLastLine(const QChar *data, int length);
+    void newLine();
+    int enforceRetention();
+    void spill(const Chunk &chunk);
+
+    QStringRef lineRef(int line) const;
+    Position positionForOffset(int chunkIndex, int offset) const;
+    int offsetForPosition(const Position &position) const;
+    int headerLines() const;
+    QString headerText() const;
+
+    void updateScrollBars();
+    void selectRange(const Position &start, const Position &end);
+    void selectionRange(Position *start, Position *end) const;
+    void ensureVisible(const Position &position);
+    Position positionAt(const QPoint &point) const;
+    int xForColumn(const QStringRef &line, int column) const;
+
+    QList<Chunk> m_chunks;
+    int m_lineCount = 0;
+    int m_maxLineLength = 0; // 内存中最长一行的字符数，用于水平滚动范围
+    qint64 m_bytes = 0;      // 内存中的输出大小（估算）
+    qint64 m_retentionLimit = kDefaultRetentionBytes;
+    qint64 m_spillLimit = kDefaultSpillLimitBytes;
+
+    QTemporaryFile *m_spillFile = nullptr;
+    qint64 m_spilledBytes = 0;
+    qint64 m_spilledLines = 0;
+    qint64 m_discardedLines = 0;
+
+    Position m_anchor; // 选区起点（按下鼠标的位置）
+    Position m_cursor; // 选区终点
+    bool m_selecting = false;
+
+    QString m_searchText;
+    TextSearch::Options m_searchOptions = TextSearch::NoOptions;
+};
+
+#endif // OUTPUTCONSOLE_H
@@ -0,0 +1,242 @@
+#include "pchcache.h"
+#include "compilecache.h"
+#include "compilerbackend.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QStandardPaths>
+
+PchCache::PchCache(const QByteArray &headerText, const QString &headerName,
+                   const QString &directory, QObject *parent)
+    : QObject(parent)
+{
+    QString root = directory;
+    if (root.isEmpty())
+        root = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/pch";
+
+    // gcc不检查头文件内容是否与预编译头一致，内容变化后必须换目录，避免用到旧的预编译头
+    QByteArray textHash = QCryptographicHash::hash(headerText, QCryptographicHash::Sha1).toHex().left(12);
+    m_directory = QDir(root).absoluteFilePath(QString::fromLatin1(textHash));
+    m_headerPath = QDir(m_directory).absoluteFilePath(headerName);
+    if (!QDir().mkpath(m_headerPath + ".gch"))
+        return;
+
+    QFile file(m_headerPath);
+    if (file.open(QIODevice::ReadOnly) && file.readAll() == headerText)
+    {
+        m_valid = true;
+        return;
+    }
+    file.close();
+    m_valid = file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(headerText) == headerText.size();
+}
+
+// 结束仍在运行的生成进程，未完成的临时文件留在目录中，下次生成时覆盖
+PchCache::~PchCache()
+{
+    const QList<QProcess *> processes = findChildren<QProcess *>();
+    for (QProcess *process : processes)
+    {
+        process->disconnect();
+        if (process->state() != QProcess::NotRunning)
+            process->kill();
+    }
+}
+
+bool PchCache::isValid() const
+{
+    return m_valid;
+}
+
+QString PchCache::headerPath() const
+{
+    return m_headerPath;
+}
+
+// 基础键：编译器标识和编译参数，编译器升级或参数变化时生成新的预编译头
+QString PchCache::baseKey(const CompilerBackend *backend, const BuildProfile &profile) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(CompileCache::compilerIdentity(backend->program()));
+    hash.addData("\n");
+    hash.addData(backend->compileFlags(profile).join('\n').toUtf8());
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+// 键："基础键-头文件标识"，头文件标识取自预置头文件引用的系统头文件（stdio.h、stdlib.h及其包含的文件）
+// 的路径、修改时间和大小；只升级C库头文件时gcc不会发现预编译头已过期，换一个键重新生成。
+// 预处理结果中的#pragma GCC pch_preprocess引用键对应的文件，编译缓存的键也随之改变
+QString PchCache::makeKey(const CompilerBackend *backend, const BuildProfile &profile) const
+{
+    const QString base = baseKey(backend, profile);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QString &path : dependencies(base))
+    {
+        QFileInfo info(path);
+        hash.addData(QString("\n%1|%2|%3")
+                         .arg(path)
+                         .arg(info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1)
+                         .arg(info.size())
+                         .toUtf8());
+    }
+    return base + '-' + QString::fromLatin1(hash.result().toHex());
+}
+
+QString PchCache::entryPath(const QString &key) const
+{
+    return QString("%1.gch/%2.gch").arg(m_headerPath, key);
+}
+
+QString PchCache::manifestPath(const QString &baseKey) const
+{
+    return QDir(m_directory).absoluteFilePath(baseKey + ".deps");
+}
+
+// 清单文件每行一个头文件路径，由生成预编译头时gcc输出的依赖写入；尚未生成过时为空
+QStringList PchCache::dependencies(const QString &baseKey) const
+{
+    auto cached = m_dependencies.constFind(baseKey);
+    if (cached != m_dependencies.constEnd())
+        return cached.value();
+
+    QStringList paths;
+    QFile file(manifestPath(baseKey));
+    if (file.open(QIODevice::ReadOnly))
+        paths = QString::fromLocal8Bit(file.readAll()).split('\n', QString::SkipEmptyParts);
+    m_dependencies.insert(baseKey, paths);
+    return paths;
+}
+
+// 从gcc -MD输出的依赖文件（"目标: 依赖 依赖 \"格式）中取出头文件路径写入清单，预置头文件本身除外
+void PchCache::saveDependencies(const QString &baseKey, const QString &dependencyFile)
+{
+    QFile input(dependencyFile);
+    if (!input.open(QIODevice::ReadOnly))
+        return;
+    QString text = QString::fromLocal8Bit(input.readAll());
+    input.close();
+    QFile::remove(dependencyFile);
+
+    text.replace("\\\n", " ");
+    const int colon = text.indexOf(": ");
+    const QStringList words =
+        text.mid(colon < 0 ? 0 : colon + 2).split(QRegularExpression("\\s+"), QString::SkipEmptyParts);
+    QStringList paths;
+    for (const QString &word : words)
+    {
+        const QString path = QFileInfo(word).absoluteFilePath();
+        if (path != m_headerPath && !paths.contains(path))
+            paths.append(path);
+    }
+
+    QFile manifest(manifestPath(baseKey));
+    if (manifest.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        manifest.write(paths.join('\n').toLocal8Bit());
+    m_dependencies.insert(baseKey, paths);
+}
+
+// 删除同一基础键下按旧头文件生成的预编译头（包括键中还没有头文件标识时生成的）：
+// 参数相同，gcc会把它当作有效的预编译头使用
+void PchCache::removeStaleEntries(const QString &key)
+{
+    const QString base = key.section('-', 0, 0);
+    QDir dir(m_headerPath + ".gch");
+    const QStringList entries = dir.entryList(QStringList() << base + "*.gch", QDir::Files);
+    for (const QString &entry : entries)
+    {
+        if (entry != key + ".gch")
+            dir.remove(entry);
+    }
+}
+
+bool PchCache::isReady(const CompilerBackend *backend, const BuildProfile &profile) const
+{
+    return m_valid && backend->supportsPrecompiledHeaders() &&
+           QFile::exists(entryPath(makeKey(backend, profile)));
+}
+
+void PchCache::prepare(const CompilerBackend *backend, const BuildProfile &profile)
+{
+    if (!m_valid || !backend->supportsPrecompiledHeaders() || !backend->isAvailable())
+        return;
+
+    const QString key = makeKey(backend, profile);
+    if (m_pending.contains(key) || m_failed.contains(key))
+        return;
+
+    // 已存在时刷新修改时间，淘汰时按最久未使用计算
+    QFile entry(entryPath(key));
+    if (entry.exists())
+    {
+        if (entry.open(QIODevice::ReadWrite))
+            entry.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        return;
+    }
+
+    removeStaleEntries(key);
+
+    // 先写到.gch目录之外，完成后再移入，gcc不会读到写了一半的文件
+    // 同时输出依赖，记下预置头文件实际引用的系统头文件；头文件有变化时生成后的键与生成前不同
+    const QString tempPath = QDir(m_directory).absoluteFilePath(key + ".tmp");
+    const QString dependencyPath = tempPath + ".d";
+    QStringList arguments = backend->precompileArguments(profile, m_headerPath, tempPath);
+    arguments << "-MD" << "-MF" << dependencyPath;
+    qDebug() << "生成预编译头:" << backend->program() << arguments;
+
+    QProcess *process = new QProcess(this);
+    process->setProcessChannelMode(QProcess::MergedChannels);
+    m_pending.insert(key);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, process, key, tempPath, dependencyPath, backend, profile](int exitCode, QProcess::ExitStatus exitStatus)
+            {
+        bool success = exitStatus == QProcess::NormalExit && exitCode == 0;
+        if (success)
+        {
+            saveDependencies(baseKey(backend, profile), dependencyPath);
+            const QString finalKey = makeKey(backend, profile);
+            removeStaleEntries(finalKey);
+            QFile::remove(entryPath(finalKey));
+            success = QFile::rename(tempPath, entryPath(finalKey));
+        }
+        if (!success)
+        {
+            qDebug() << "预编译头生成失败:" << process->readAll();
+            QFile::remove(tempPath);
+            QFile::remove(dependencyPath);
+        }
+        process->deleteLater();
+        onGenerateFinished(key, success); });
+    connect(process, &QProcess::errorOccurred, this, [this, process, key](QProcess::ProcessError error)
+            {
+        if (error != QProcess::FailedToStart)
+            return;
+        process->deleteLater();
+        onGenerateFinished(key, false); });
+
+    process->start(backend->executablePath(), arguments);
+    process->closeWriteChannel();
+}
+
+void PchCache::onGenerateFinished(const QString &key, bool success)
+{
+    m_pending.remove(key);
+    if (success)
+        evict();
+    else
+        m_failed.insert(key);
+    emit prepared(success);
+}
+
+// 按修改时间从旧到新删除多余的预编译头
+void PchCache::evict()
+{
+    QDir dir(m_headerPath + ".gch");
+    QFileInfoList entries = dir.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+    for (int i = 0; i < entries.size() - kMaxEntries; ++i)
+        QFile::remove(entries.at(i).absoluteFilePath());
+}
@@ -0,0 +1,60 @@
+#ifndef PCHCACHE_H
+#define PCHCACHE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include "buildprofile.h"
+
+class CompilerBackend;
+
+// 预编译头缓存：为预置头文件按编译器和编译参数生成GCC预编译头，保存在"头文件名.gch"目录中，
+// gcc编译时从中自动挑选与当前参数匹配的一个；生成在后台进行，完成前的编译照常解析头文件
+class PchCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 每个头文件最多保留的预编译头数量（每个约几MB）
+    static const int kMaxEntries = 16;
+
+    // directory为空时使用系统缓存目录下的pch子目录；头文件内容不同时放在不同子目录，互不影响
+    PchCache(const QByteArray &headerText, const QString &headerName,
+             const QString &directory = QString(), QObject *parent = nullptr);
+    ~PchCache() override;
+
+    bool isValid() const;
+    // 供-include引用的头文件绝对路径，同目录下有对应的.gch目录
+    QString headerPath() const;
+
+    // 与profile对应的预编译头是否已生成
+    bool isReady(const CompilerBackend *backend, const BuildProfile &profile) const;
+    // 尚未生成时在后台生成；已生成、正在生成、曾经失败或编译器不支持时直接返回
+    void prepare(const CompilerBackend *backend, const BuildProfile &profile);
+
+signals:
+    void prepared(bool success);
+
+private:
+    QString baseKey(const CompilerBackend *backend, const BuildProfile &profile) const;
+    QString makeKey(const CompilerBackend *backend, const BuildProfile &profile) const;
+    QString entryPath(const QString &key) const;
+    QString manifestPath(const QString &baseKey) const;
+    QStringList dependencies(const QString &baseKey) const;
+    void saveDependencies(const QString &baseKey, const QString &dependencyFile);
+    void removeStaleEntries(const QString &key);
+    void onGenerateFinished(const QString &key, bool success);
+    void evict();
+
+    QString m_directory;  // 当前头文件内容对应的子目录
+    QString m_headerPath;
+    bool m_valid = false;
+    QSet<QString> m_pending; // 正在生成的键
+    QSet<QString> m_failed;  // 生成失败的键，本次会话不再重试
+    mutable QHash<QString, QStringList> m_dependencies; // 各基础键对应的系统头文件，从清单文件读取
+};
+
+#endif // PCHCACHE_H
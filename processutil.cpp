@@ -0,0 +1,45 @@
+#include "processutil.h"
+#include <QProcess>
+#include <QStringList>
+#include <QTimer>
+
+void ProcessUtil::retire(QProcess *process)
+{
+    if (!process)
+        return;
+
+    process->disconnect();
+    if (process->state() == QProcess::NotRunning)
+    {
+        process->deleteLater();
+        return;
+    }
+
+    QObject::connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                     process, &QObject::deleteLater);
+    process->terminate();
+    QTimer::singleShot(kTerminateGraceMs, process, [process]()
+                       {
+        if (process->state() != QProcess::NotRunning)
+            process->kill(); });
+}
+
+void ProcessUtil::probeOptions(QObject *context, const QString &program, const QStringList &options,
+                               const std::function<void(bool)> &callback)
+{
+    QProcess *probe = new QProcess(context);
+    QObject::connect(probe, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), context,
+                     [probe, callback](int exitCode, QProcess::ExitStatus exitStatus)
+                     {
+        probe->deleteLater();
+        callback(exitStatus == QProcess::NormalExit && exitCode == 0); });
+    QObject::connect(probe, &QProcess::errorOccurred, context, [probe, callback](QProcess::ProcessError error)
+                     {
+        if (error != QProcess::FailedToStart)
+            return;
+        probe->deleteLater();
+        callback(false); });
+
+    probe->start(program, QStringList() << options << "-E" << "-x" << "c" << "-");
+    probe->closeWriteChannel();
+}
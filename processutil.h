@@ -0,0 +1,28 @@
+#ifndef PROCESSUTIL_H
+#define PROCESSUTIL_H
+
+#include <functional>
+
+class QObject;
+class QProcess;
+class QString;
+class QStringList;
+
+// 子进程相关的辅助函数
+class ProcessUtil
+{
+public:
+    // 请求结束后等待多久再强制结束（毫秒）
+    static const int kTerminateGraceMs = 1500;
+
+    // 让不再需要的进程退出：断开所有信号，先请求结束（SIGTERM），宽限期后仍在运行则强制结束（SIGKILL），
+    // 进程结束后自动释放；整个过程不阻塞调用线程
+    static void retire(QProcess *process);
+
+    // 异步检测编译器是否接受某些选项：以这些选项预处理一段空输入，成功退出即为支持；
+    // 结果通过callback报告，编译器无法启动时报告不支持。context销毁后不再回调
+    static void probeOptions(QObject *context, const QString &program, const QStringList &options,
+                             const std::function<void(bool)> &callback);
+};
+
+#endif // PROCESSUTIL_H
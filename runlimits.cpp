@@ -0,0 +1,111 @@
+#include "runlimits.h"
+#include <QFile>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    QString limitText(qint64 value, const QString &unit)
+    {
+        return value > 0 ? QString("%1 %2").arg(value).arg(unit) : QString("不限");
+    }
+
+#ifdef Q_OS_UNIX
+    void setLimit(int resource, rlim_t soft, rlim_t hard)
+    {
+        struct rlimit limit;
+        limit.rlim_cur = soft;
+        limit.rlim_max = hard;
+        setrlimit(resource, &limit);
+    }
+
+    double seconds(const struct timeval &time)
+    {
+        return time.tv_sec + time.tv_usec / 1e6;
+    }
+#endif
+}
+
+QString RunLimits::description() const
+{
+    return QString("运行时间 %1，CPU时间 %2，内存 %3，输出 %4")
+        .arg(limitText(wallTimeSeconds, "s"))
+        .arg(limitText(cpuTimeSeconds, "s"))
+        .arg(limitText(memoryBytes / (1024 * 1024), "MB"))
+        .arg(limitText(outputBytes / (1024 * 1024), "MB"));
+}
+
+void RunLimits::applyToCurrentProcess(qint64 baseAddressSpace) const
+{
+#ifdef Q_OS_UNIX
+    // 超过CPU时间软限制时收到SIGXCPU，忽略该信号的程序再过1秒被SIGKILL
+    if (cpuTimeSeconds > 0)
+        setLimit(RLIMIT_CPU, rlim_t(cpuTimeSeconds), rlim_t(cpuTimeSeconds) + 1);
+    // 地址空间上限：超出后内存分配失败，而不是拖垮整个系统
+    if (memoryBytes > 0 && baseAddressSpace >= 0)
+        setLimit(RLIMIT_AS, rlim_t(baseAddressSpace + memoryBytes), rlim_t(baseAddressSpace + memoryBytes));
+#else
+    Q_UNUSED(baseAddressSpace)
+#endif
+}
+
+// /proc/self/statm的第一项是以页为单位的地址空间大小
+qint64 RunLimits::currentAddressSpace()
+{
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/statm");
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+    bool ok = false;
+    const qint64 pages = file.readLine().split(' ').value(0).toLongLong(&ok);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    return ok && pageSize > 0 ? pages * pageSize : -1;
+#else
+    return -1;
+#endif
+}
+
+bool RunLimits::operator==(const RunLimits &other) const
+{
+    return wallTimeSeconds == other.wallTimeSeconds && cpuTimeSeconds == other.cpuTimeSeconds &&
+           memoryBytes == other.memoryBytes && outputBytes == other.outputBytes;
+}
+
+bool RunLimits::operator!=(const RunLimits &other) const
+{
+    return !(*this == other);
+}
+
+QString RunUsage::toString() const
+{
+    QString text = QString("耗时 %1 s").arg(wallMs / 1000.0, 0, 'f', 3);
+    if (!hasResourceUsage)
+        return text;
+
+    return text + QString("，用户 %1 s，系统 %2 s，峰值内存 %3 MB，上下文切换 %4/%5（主动/被动）")
+                      .arg(userSeconds, 0, 'f', 3)
+                      .arg(systemSeconds, 0, 'f', 3)
+                      .arg(peakRssBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                      .arg(voluntarySwitches)
+                      .arg(involuntarySwitches);
+}
+
+#ifdef Q_OS_UNIX
+// 来自wait4的统计；ru_maxrss在Linux上以KB为单位，在macOS上以字节为单位
+void RunUsage::setResourceUsage(const struct rusage &resources)
+{
+    hasResourceUsage = true;
+    userSeconds = seconds(resources.ru_utime);
+    systemSeconds = seconds(resources.ru_stime);
+#ifdef Q_OS_MACOS
+    peakRssBytes = resources.ru_maxrss;
+#else
+    peakRssBytes = qint64(resources.ru_maxrss) * 1024;
+#endif
+    voluntarySwitches = resources.ru_nvcsw;
+    involuntarySwitches = resources.ru_nivcsw;
+}
+#endif
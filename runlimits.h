@@ -0,0 +1,50 @@
+#ifndef RUNLIMITS_H
+#define RUNLIMITS_H
+
+#include <QtGlobal>
+#include <QString>
+
+#ifdef Q_OS_UNIX
+struct rusage;
+#endif
+
+// 运行用户程序时的资源限制，0表示不限制
+// CPU时间和地址空间通过setrlimit在子进程中设置，仅Unix有效；运行时间和输出量由IDE统计，所有平台有效
+struct RunLimits
+{
+    int wallTimeSeconds = 0;
+    int cpuTimeSeconds = 60;
+    qint64 memoryBytes = 2048LL * 1024 * 1024;
+    qint64 outputBytes = 256LL * 1024 * 1024;
+
+    // 用于界面显示的简短描述
+    QString description() const;
+    // 在fork出的子进程中调用，设置CPU时间和地址空间限制；只调用异步信号安全的函数
+    // exec之前调用时baseAddressSpace为0，exec会换掉整个地址空间；fork后不exec的子进程继承了父进程的
+    // 地址空间，传入fork前父进程占用的大小，上限在此基础上再加memoryBytes；小于0时不限制地址空间
+    void applyToCurrentProcess(qint64 baseAddressSpace = 0) const;
+    // 当前进程已占用的地址空间（字节），无法取得时返回-1；仅Linux可用
+    static qint64 currentAddressSpace();
+
+    bool operator==(const RunLimits &other) const;
+    bool operator!=(const RunLimits &other) const;
+};
+
+// 一次运行的资源使用统计；CPU时间、峰值内存和上下文切换来自wait4，不可用时hasResourceUsage为false
+struct RunUsage
+{
+    double wallMs = 0; // 从启动到退出的耗时（毫秒）
+    bool hasResourceUsage = false;
+    double userSeconds = 0;
+    double systemSeconds = 0;
+    qint64 peakRssBytes = 0;
+    qint64 voluntarySwitches = 0;
+    qint64 involuntarySwitches = 0;
+
+    QString toString() const;
+#ifdef Q_OS_UNIX
+    void setResourceUsage(const struct rusage &resources);
+#endif
+};
+
+#endif // RUNLIMITS_H
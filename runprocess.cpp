@@ -0,0 +1,492 @@
+#include "runprocess.h"
+#include "processutil.h"
+#include <QFile>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#ifdef Q_OS_UNIX
+#define RUNPROCESS_ENABLED
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#if defined(Q_OS_MACOS)
+#include <util.h>
+#elif defined(Q_OS_FREEBSD)
+#include <libutil.h>
+#else
+#include <pty.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#endif
+#endif
+
+// 轮询子进程是否退出的间隔（毫秒）
+static const int kPollIntervalMs = 10;
+// 每批最多读取输出的次数
+static const int kMaxReadsPerBatch = 16;
+
+#ifdef RUNPROCESS_ENABLED
+namespace
+{
+    void setCloseOnExec(int fd)
+    {
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    void closeFd(int &fd)
+    {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+
+    void reportErrno(int fd)
+    {
+        int error = errno;
+        ssize_t ignored = ::write(fd, &error, sizeof(error));
+        (void)ignored;
+    }
+
+    // 子进程：设置资源限制后exec，失败时经errorFd回报errno；fork之后只调用异步信号安全的函数
+    [[noreturn]] void execChild(const char *path, const char *directory, const RunLimits &limits, int cpu,
+                                int errorFd)
+    {
+        limits.applyToCurrentProcess();
+#ifdef Q_OS_LINUX
+        // 绑定失败（CPU编号不存在或不在允许的集合中）时按不绑定运行
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            sched_setaffinity(0, sizeof(set), &set);
+        }
+#else
+        (void)cpu;
+#endif
+        if (*directory && chdir(directory) != 0)
+        {
+            reportErrno(errorFd);
+            _exit(127);
+        }
+        execl(path, path, static_cast<char *>(nullptr));
+        reportErrno(errorFd);
+        _exit(127);
+    }
+}
+#endif
+
+RunProcess::RunProcess(QObject *parent)
+    : QObject(parent),
+      m_pollTimer(new QTimer(this))
+{
+    m_pollTimer->setInterval(kPollIntervalMs);
+    connect(m_pollTimer, &QTimer::timeout, this, &RunProcess::pollChild);
+}
+
+RunProcess::~RunProcess()
+{
+#ifdef RUNPROCESS_ENABLED
+    if (m_pid > 0)
+    {
+        kill(pid_t(m_pid), SIGKILL);
+        waitpid(pid_t(m_pid), nullptr, 0);
+    }
+#endif
+    closeChannels();
+}
+
+bool RunProcess::isSupported()
+{
+#ifdef RUNPROCESS_ENABLED
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool RunProcess::isRunning() const
+{
+    return m_pid > 0;
+}
+
+QString RunProcess::errorString() const
+{
+    return m_errorString;
+}
+
+void RunProcess::setInputFile(const QString &fileName)
+{
+    m_inputFile = fileName;
+}
+
+void RunProcess::setCpuAffinity(int cpu)
+{
+    m_cpu = cpu;
+}
+
+bool RunProcess::start(const QString &program, const QString &workingDirectory, const RunLimits &limits,
+                       bool terminal)
+{
+#ifdef RUNPROCESS_ENABLED
+    if (m_pid > 0)
+    {
+        kill(pid_t(m_pid), SIGKILL);
+        waitpid(pid_t(m_pid), nullptr, 0); // SIGKILL后子进程立即退出，回收不会阻塞
+        m_pid = -1;
+        m_pollTimer->stop();
+    }
+    closeChannels();
+
+    // exec失败时子进程经此管道回报errno；exec成功后管道随之关闭
+    int errorPipe[2];
+    if (pipe(errorPipe) != 0)
+    {
+        m_errorString = QString::fromLocal8Bit(strerror(errno));
+        return false;
+    }
+    setCloseOnExec(errorPipe[0]);
+    setCloseOnExec(errorPipe[1]);
+
+    // 管道模式：标准输入来自输入文件或socketpair，标准输出和标准错误共用一个管道
+    int inputFile = -1;
+    int input[2] = {-1, -1};
+    int output[2] = {-1, -1};
+    bool channelsReady = true;
+    if (!terminal)
+    {
+        if (!m_inputFile.isEmpty())
+        {
+            inputFile = open(QFile::encodeName(m_inputFile).constData(), O_RDONLY);
+            channelsReady = inputFile >= 0;
+        }
+        else
+        {
+            channelsReady = socketpair(AF_UNIX, SOCK_STREAM, 0, input) == 0;
+        }
+        channelsReady = channelsReady && pipe(output) == 0;
+    }
+    if (!channelsReady)
+    {
+        m_errorString = QString::fromLocal8Bit(strerror(errno));
+        for (int fd : {errorPipe[0], errorPipe[1], inputFile, input[0], input[1], output[0], output[1]})
+        {
+            if (fd >= 0)
+                close(fd);
+        }
+        return false;
+    }
+    for (int fd : {inputFile, input[0], input[1], output[0], output[1]})
+    {
+        if (fd >= 0)
+            setCloseOnExec(fd);
+    }
+
+    // 子进程中不再分配内存，参数在fork前准备好
+    const QByteArray path = QFile::encodeName(program);
+    const QByteArray directory = QFile::encodeName(workingDirectory);
+    int master = -1;
+    pid_t pid;
+    if (terminal)
+    {
+        struct winsize size;
+        memset(&size, 0, sizeof(size));
+        size.ws_row = 24;
+        size.ws_col = 120;
+        pid = forkpty(&master, nullptr, nullptr, &size);
+    }
+    else
+    {
+        pid = fork();
+    }
+
+    if (pid < 0)
+    {
+        m_errorString = QString::fromLocal8Bit(strerror(errno));
+        for (int fd : {errorPipe[0], errorPipe[1], inputFile, input[0], input[1], output[0], output[1]})
+        {
+            if (fd >= 0)
+                close(fd);
+        }
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        if (terminal)
+        {
+            // 关闭终端回显（输入已由界面显示）和输出时的"\n"到"\r\n"转换
+            struct termios mode;
+            if (tcgetattr(STDIN_FILENO, &mode) == 0)
+            {
+                mode.c_lflag &= ~tcflag_t(ECHO | ECHONL);
+                mode.c_oflag &= ~tcflag_t(ONLCR);
+                tcsetattr(STDIN_FILENO, TCSANOW, &mode);
+            }
+        }
+        else
+        {
+            dup2(inputFile >= 0 ? inputFile : input[1], STDIN_FILENO);
+            dup2(output[1], STDOUT_FILENO);
+            dup2(output[1], STDERR_FILENO);
+        }
+        execChild(path.constData(), directory.constData(), limits, m_cpu, errorPipe[1]);
+    }
+
+    close(errorPipe[1]);
+    if (terminal)
+    {
+        setCloseOnExec(master);
+        m_inputFd = master;
+        m_outputFd = master;
+    }
+    else
+    {
+        if (inputFile >= 0)
+            close(inputFile);
+        else
+            close(input[1]);
+        close(output[1]);
+        m_inputFd = input[0];
+        m_outputFd = output[0];
+    }
+    m_terminal = terminal;
+
+    // 等待exec结果：读到errno说明启动失败，读到文件结束说明exec已成功
+    int error = 0;
+    ssize_t n;
+    do
+    {
+        n = read(errorPipe[0], &error, sizeof(error));
+    } while (n < 0 && errno == EINTR);
+    close(errorPipe[0]);
+    if (n == ssize_t(sizeof(error)))
+    {
+        waitpid(pid, nullptr, 0);
+        closeChannels();
+        m_errorString = QString::fromLocal8Bit(strerror(error));
+        return false;
+    }
+
+    fcntl(m_outputFd, F_SETFL, fcntl(m_outputFd, F_GETFL) | O_NONBLOCK);
+    m_pid = pid;
+    m_stopRequested = false;
+    m_errorString.clear();
+    m_outputClosedNs = -1;
+    m_clock.start();
+
+    m_notifier = new QSocketNotifier(m_outputFd, QSocketNotifier::Read, this);
+    m_notifier->setEnabled(!m_outputPaused);
+    connect(m_notifier, &QSocketNotifier::activated, this, &RunProcess::onOutputReady);
+    m_pollTimer->start();
+    emit started();
+    return true;
+#else
+    Q_UNUSED(program)
+    Q_UNUSED(workingDirectory)
+    Q_UNUSED(limits)
+    Q_UNUSED(terminal)
+    m_errorString = tr("当前平台不支持");
+    return false;
+#endif
+}
+
+void RunProcess::write(const QByteArray &data)
+{
+#ifdef RUNPROCESS_ENABLED
+    if (m_inputFd < 0 || data.isEmpty())
+        return;
+
+    // 已有数据排队时追加在后面，保持写入顺序
+    m_pendingInput.append(data);
+    if (!m_inputNotifier || !m_inputNotifier->isEnabled())
+        writePendingInput();
+#else
+    Q_UNUSED(data)
+#endif
+}
+
+void RunProcess::onInputReady()
+{
+    writePendingInput();
+}
+
+// 写入排队的数据，写满时等待可写通知后继续；程序已退出或关闭标准输入时丢弃剩余数据
+void RunProcess::writePendingInput()
+{
+#ifdef RUNPROCESS_ENABLED
+    int offset = 0;
+    bool blocked = false;
+    while (offset < m_pendingInput.size())
+    {
+        // 伪终端在程序退出后写入返回EIO；socketpair用MSG_NOSIGNAL避免读端关闭时触发SIGPIPE
+        const char *p = m_pendingInput.constData() + offset;
+        const size_t remaining = size_t(m_pendingInput.size() - offset);
+        ssize_t written = m_terminal ? ::write(m_inputFd, p, remaining)
+                                     : send(m_inputFd, p, remaining, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (written > 0)
+        {
+            offset += int(written);
+            continue;
+        }
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            blocked = true;
+        else
+            offset = m_pendingInput.size();
+        break;
+    }
+    m_pendingInput.remove(0, offset);
+
+    if (blocked && !m_inputNotifier)
+    {
+        m_inputNotifier = new QSocketNotifier(m_inputFd, QSocketNotifier::Write, this);
+        connect(m_inputNotifier, &QSocketNotifier::activated, this, &RunProcess::onInputReady);
+    }
+    if (m_inputNotifier)
+        m_inputNotifier->setEnabled(blocked);
+#endif
+}
+
+void RunProcess::setOutputPaused(bool paused)
+{
+    m_outputPaused = paused;
+    // 输出已关闭时通知器保持禁用
+    if (m_notifier && m_outputClosedNs < 0)
+        m_notifier->setEnabled(!paused);
+}
+
+void RunProcess::stop()
+{
+#ifdef RUNPROCESS_ENABLED
+    if (m_pid <= 0)
+        return;
+
+    const qint64 pid = m_pid;
+    m_stopRequested = true;
+    kill(pid_t(pid), SIGTERM);
+    QTimer::singleShot(ProcessUtil::kTerminateGraceMs, this, [this, pid]()
+                       {
+        if (m_pid == pid)
+            kill(pid_t(pid), SIGKILL); });
+#endif
+}
+
+void RunProcess::onOutputReady()
+{
+    readOutput();
+}
+
+// 读取一批输出，返回是否可能还有未读的数据；读取中途被暂停时立即返回，剩余数据留在管道中
+// 伪终端的从设备关闭后Linux上读取返回EIO，与文件结束同样处理
+bool RunProcess::readOutput()
+{
+#ifdef RUNPROCESS_ENABLED
+    if (m_outputFd < 0)
+        return false;
+
+    char buffer[65536];
+    for (int i = 0; i < kMaxReadsPerBatch; ++i)
+    {
+        ssize_t n = read(m_outputFd, buffer, sizeof(buffer));
+        if (n > 0)
+        {
+            emit outputReceived(QByteArray(buffer, int(n)));
+            if (m_outputPaused)
+                return true;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n == 0 || errno != EAGAIN)
+        {
+            m_notifier->setEnabled(false);
+            if (m_outputClosedNs < 0)
+                m_outputClosedNs = m_clock.nsecsElapsed();
+        }
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+// 检查子进程是否已退出，同时读完剩余输出；用wait4回收以取得资源使用统计
+void RunProcess::pollChild()
+{
+#ifdef RUNPROCESS_ENABLED
+    if (m_pid <= 0)
+        return;
+
+    int status = 0;
+    struct rusage resources;
+    pid_t result = wait4(pid_t(m_pid), &status, WNOHANG, &resources);
+    if (result == 0 || (result < 0 && errno == EINTR))
+        return;
+
+    RunUsage usage;
+    usage.wallMs = (m_outputClosedNs >= 0 ? m_outputClosedNs : m_clock.nsecsElapsed()) / 1e6;
+    if (result > 0)
+        usage.setResourceUsage(resources);
+
+    while (readOutput())
+    {
+    }
+    finish(status, usage);
+#endif
+}
+
+void RunProcess::finish(int status, const RunUsage &usage)
+{
+#ifdef RUNPROCESS_ENABLED
+    m_pid = -1;
+    m_pollTimer->stop();
+    closeChannels();
+
+    if (m_stopRequested)
+    {
+        emit finished(-1, true, "程序已被用户终止", usage);
+    }
+    else if (WIFSIGNALED(status))
+    {
+        int signal = WTERMSIG(status);
+        if (signal == SIGXCPU)
+            emit finished(-1, true, "程序超过CPU时间限制，已被终止", usage);
+        else
+            emit finished(-1, true, QString("程序被信号%1（%2）终止").arg(signal).arg(strsignal(signal)), usage);
+    }
+    else
+    {
+        int exitCode = WEXITSTATUS(status);
+        emit finished(exitCode, false, QString("程序运行结束\n退出代码: %1\n").arg(exitCode), usage);
+    }
+#else
+    Q_UNUSED(status)
+    Q_UNUSED(usage)
+#endif
+}
+
+void RunProcess::closeChannels()
+{
+    delete m_notifier;
+    m_notifier = nullptr;
+    delete m_inputNotifier;
+    m_inputNotifier = nullptr;
+    m_pendingInput.clear();
+#ifdef RUNPROCESS_ENABLED
+    if (m_inputFd == m_outputFd)
+        m_inputFd = -1;
+    closeFd(m_inputFd);
+    closeFd(m_outputFd);
+#endif
+}
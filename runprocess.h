@@ -0,0 +1,75 @@
+#ifndef RUNPROCESS_H
+#define RUNPROCESS_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include "runlimits.h"
+
+class QSocketNotifier;
+class QTimer;
+
+// 运行用户程序：fork后在子进程中设置资源限制再exec，回收时用wait4取得资源使用统计；仅支持Unix
+// 可在伪终端上运行（C运行库检测到终端后按行缓冲，提示及时显示），也可使用管道（标准输出全缓冲）
+class RunProcess : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RunProcess(QObject *parent = nullptr);
+    ~RunProcess() override;
+
+    static bool isSupported();
+
+    // 启动程序，正在运行的程序会先被结束；失败时返回false，原因见errorString()
+    bool start(const QString &program, const QString &workingDirectory, const RunLimits &limits,
+               bool terminal);
+    // 管道模式下从文件读取标准输入（此时write()不再有效），为空时使用socketpair；在下一次start时生效
+    void setInputFile(const QString &fileName);
+    // 把程序绑定到指定CPU上运行，-1表示不绑定；仅Linux有效，在下一次start时生效
+    void setCpuAffinity(int cpu);
+    bool isRunning() const;
+    QString errorString() const;
+    // 写入标准输入；程序暂时读不完的部分排队，可写时继续写入，不阻塞界面线程
+    void write(const QByteArray &data);
+    // 暂停或恢复读取输出：暂停期间程序写满管道（或伪终端）后阻塞，输出不会丢失；程序退出时照常读完
+    void setOutputPaused(bool paused);
+    // 先SIGTERM，宽限期后SIGKILL
+    void stop();
+
+signals:
+    void started();
+    // 程序输出的原始字节（标准输出和标准错误合并）
+    void outputReceived(const QByteArray &data);
+    void finished(int exitCode, bool crashed, const QString &message, const RunUsage &usage);
+
+private slots:
+    void onOutputReady();
+    void onInputReady();
+    void pollChild();
+
+private:
+    bool readOutput();
+    void writePendingInput();
+    void closeChannels();
+    void finish(int status, const RunUsage &usage);
+
+    qint64 m_pid = -1;
+    int m_outputFd = -1; // 伪终端主设备，或输出管道的读端
+    int m_inputFd = -1;  // 伪终端主设备，或标准输入socketpair的一端（写入时不触发SIGPIPE）
+    bool m_terminal = false;
+    QString m_inputFile;
+    int m_cpu = -1;
+    bool m_stopRequested = false;
+    bool m_outputPaused = false;
+    QString m_errorString;
+    QElapsedTimer m_clock;
+    qint64 m_outputClosedNs = -1; // 输出端关闭的时刻，近似程序退出的时刻，不受轮询间隔影响
+    QSocketNotifier *m_notifier = nullptr;
+    QByteArray m_pendingInput;                  // 尚未写入标准输入的数据
+    QSocketNotifier *m_inputNotifier = nullptr; // 有待写数据时等待标准输入可写
+    QTimer *m_pollTimer;
+};
+
+#endif // RUNPROCESS_H
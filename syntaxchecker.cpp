@@ -0,0 +1,282 @@
+#include "syntaxchecker.h"
+#include "editor.h"
+#include "processutil.h"
+#include <QCryptographicHash>
+#include <QProcess>
+#include <QThread>
+#include <QTimer>
+
+// 默认停止输入后的等待时间（毫秒）
+static const int kDefaultDebounceMs = 600;
+
+SyntaxChecker::SyntaxChecker(QObject *parent)
+    : QObject(parent),
+      m_debounceMs(kDefaultDebounceMs),
+      m_maxConcurrent(qBound(1, QThread::idealThreadCount() / 2, 4)),
+      m_cache(kCacheSize)
+{
+    // 文本诊断的列号按字节报告（gcc 11起默认按显示宽度），旧版gcc不接受这个选项
+    ProcessUtil::probeOptions(this, "gcc", QStringList() << DiagnosticMapper::kByteColumnsOption,
+                              [this](bool supported) { m_byteColumns = supported; });
+}
+
+SyntaxChecker::~SyntaxChecker()
+{
+    for (Job &job : m_jobs)
+        cancelRunning(job);
+}
+
+void SyntaxChecker::setDebounceInterval(int msec)
+{
+    m_debounceMs = qMax(0, msec);
+    for (Job &job : m_jobs)
+        job.timer->setInterval(m_debounceMs);
+}
+
+int SyntaxChecker::debounceInterval() const
+{
+    return m_debounceMs;
+}
+
+void SyntaxChecker::setMaxConcurrentChecks(int count)
+{
+    m_maxConcurrent = qMax(1, count);
+    startPending();
+}
+
+int SyntaxChecker::maxConcurrentChecks() const
+{
+    return m_maxConcurrent;
+}
+
+void SyntaxChecker::setExtraArguments(const QStringList &arguments)
+{
+    m_extraArguments = arguments;
+}
+
+void SyntaxChecker::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    if (!enabled)
+    {
+        for (Job &job : m_jobs)
+            job.timer->stop();
+    }
+}
+
+bool SyntaxChecker::isEnabled() const
+{
+    return m_enabled;
+}
+
+// 开始跟踪编辑器：内容变化后重新计时，并立即安排一次检查
+void SyntaxChecker::addEditor(Editor *editor, const QString &fileName)
+{
+    if (m_jobs.contains(editor))
+        return;
+
+    Job &job = m_jobs[editor];
+    job.fileName = fileName;
+    job.timer = new QTimer(this);
+    job.timer->setSingleShot(true);
+    job.timer->setInterval(m_debounceMs);
+    connect(job.timer, &QTimer::timeout, this, [this, editor]() { enqueue(editor); });
+    connect(editor->document(), &QTextDocument::contentsChanged, this,
+            [this, editor]() { onContentsChanged(editor); });
+    connect(editor, &QObject::destroyed, this, [this, editor]() { removeEditor(editor); });
+
+    if (m_enabled && !m_compilerMissing)
+        job.timer->start();
+}
+
+// 停止跟踪编辑器，结束其检查进程（编辑器可能已被销毁，只把指针当作键使用）
+void SyntaxChecker::removeEditor(Editor *editor)
+{
+    auto it = m_jobs.find(editor);
+    if (it == m_jobs.end())
+        return;
+
+    cancelRunning(*it);
+    delete it->timer;
+    m_queue.removeAll(editor);
+    m_jobs.erase(it);
+    startPending();
+}
+
+void SyntaxChecker::setFileName(Editor *editor, const QString &fileName)
+{
+    auto it = m_jobs.find(editor);
+    if (it != m_jobs.end())
+        it->fileName = fileName;
+}
+
+void SyntaxChecker::checkNow(Editor *editor, bool analyze)
+{
+    auto it = m_jobs.find(editor);
+    if (it == m_jobs.end())
+        return;
+
+    m_compilerMissing = false;
+    it->timer->stop();
+    it->analyze = it->analyze || analyze;
+    // 正在运行的是普通检查时，改为重新做静态分析
+    if (analyze && it->process)
+        cancelRunning(*it);
+    enqueue(editor);
+}
+
+// 文档修改：正在检查的快照已过期，结束检查进程并重新计时
+void SyntaxChecker::onContentsChanged(Editor *editor)
+{
+    auto it = m_jobs.find(editor);
+    if (it == m_jobs.end())
+        return;
+
+    ++it->generation;
+    cancelRunning(*it);
+    if (it->queued)
+    {
+        it->queued = false;
+        m_queue.removeAll(editor);
+    }
+    if (m_enabled && !m_compilerMissing)
+        it->timer->start();
+    startPending();
+}
+
+// 结束正在运行的检查，不等待进程退出
+void SyntaxChecker::cancelRunning(Job &job)
+{
+    if (!job.process)
+        return;
+
+    ProcessUtil::retire(job.process);
+    job.process = nullptr;
+    job.runningGeneration = -1;
+    --m_running;
+}
+
+void SyntaxChecker::enqueue(Editor *editor)
+{
+    Job &job = m_jobs[editor];
+    if (!job.queued)
+    {
+        job.queued = true;
+        m_queue.append(editor);
+    }
+    startPending();
+}
+
+// 在名额允许的范围内启动排队的检查
+void SyntaxChecker::startPending()
+{
+    while (m_running < m_maxConcurrent && !m_queue.isEmpty())
+    {
+        Editor *editor = m_queue.takeFirst();
+        Job &job = m_jobs[editor];
+        job.queued = false;
+        if (!job.process)
+            startCheck(editor);
+    }
+}
+
+QStringList SyntaxChecker::argumentsFor(bool analyze) const
+{
+    QStringList arguments;
+    if (analyze)
+    {
+        // 静态分析在中端进行，-fsyntax-only下不会执行，需要实际编译到空设备
+#ifdef Q_OS_WIN
+        arguments << "-fanalyzer" << "-c" << "-o" << "NUL";
+#else
+        arguments << "-fanalyzer" << "-c" << "-o" << "/dev/null";
+#endif
+    }
+    else
+    {
+        arguments << "-fsyntax-only";
+    }
+    arguments << "-Wall" << "-fno-diagnostics-show-caret";
+    if (m_byteColumns)
+        arguments << DiagnosticMapper::kByteColumnsOption;
+    arguments << m_extraArguments << "-x" << "c" << "-";
+    return arguments;
+}
+
+// 对当前文档快照启动检查，内容与参数相同的结果直接取自缓存
+void SyntaxChecker::startCheck(Editor *editor)
+{
+    Job &job = m_jobs[editor];
+    const bool analyze = job.analyze;
+    const QStringList arguments = argumentsFor(analyze);
+    const QByteArray source = editor->getCodeText().toLocal8Bit();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(arguments.join('\n').toUtf8());
+    hash.addData("\0", 1);
+    hash.addData(source);
+    const QByteArray key = hash.result();
+
+    if (QVector<Diagnostic> *cached = m_cache.object(key))
+    {
+        job.analyze = false;
+        emit diagnosticsReady(editor, *cached);
+        return;
+    }
+
+    QProcess *process = new QProcess(this);
+    job.process = process;
+    job.runningGeneration = job.generation;
+    job.runningKey = key;
+    job.analyze = false;
+    ++m_running;
+
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, editor, process]() { onCheckFinished(editor, process); });
+    connect(process, &QProcess::errorOccurred, this, [this, editor, process](QProcess::ProcessError error)
+            {
+        if (error != QProcess::FailedToStart)
+            return;
+        // 找不到gcc时不再自动检查，直到手动触发
+        m_compilerMissing = true;
+        onCheckFinished(editor, process); });
+    connect(process, &QProcess::started, process, [process, source]()
+            {
+        process->write(source);
+        process->closeWriteChannel(); });
+
+    process->start("gcc", arguments);
+}
+
+// 检查结束：解析诊断，缓存并通知编辑器
+void SyntaxChecker::onCheckFinished(Editor *editor, QProcess *process)
+{
+    auto it = m_jobs.find(editor);
+    if (it == m_jobs.end() || it->process != process)
+        return;
+
+    Job &job = *it;
+    job.process = nullptr;
+    --m_running;
+    process->disconnect();
+    process->deleteLater();
+
+    if (!m_compilerMissing && process->exitStatus() == QProcess::NormalExit)
+    {
+        DiagnosticMapper mapper(job.fileName);
+        QVector<Diagnostic> diagnostics;
+        const QVector<Diagnostic> parsed =
+            DiagnosticMapper::parse(QString::fromLocal8Bit(process->readAllStandardError()));
+        for (Diagnostic diagnostic : parsed)
+        {
+            if (mapper.map(&diagnostic))
+                diagnostics.append(diagnostic);
+        }
+
+        m_cache.insert(job.runningKey, new QVector<Diagnostic>(diagnostics));
+        if (job.runningGeneration == job.generation)
+            emit diagnosticsReady(editor, diagnostics);
+    }
+    job.runningGeneration = -1;
+    startPending();
+}
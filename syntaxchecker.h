@@ -0,0 +1,83 @@
+#ifndef SYNTAXCHECKER_H
+#define SYNTAXCHECKER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QCache>
+#include <QStringList>
+#include <QVector>
+#include "diagnostics.h"
+
+class Editor;
+class QProcess;
+class QTimer;
+
+// 后台语法检查：停止输入一段时间后对文档快照运行gcc -fsyntax-only（按需-fanalyzer），
+// 文档再次修改时结束过期的检查进程；结果按内容哈希缓存，同时运行的检查进程数有上限
+class SyntaxChecker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SyntaxChecker(QObject *parent = nullptr);
+    ~SyntaxChecker() override;
+
+    // 停止输入后等待多久开始检查（毫秒）
+    void setDebounceInterval(int msec);
+    int debounceInterval() const;
+    // 同时运行的检查进程上限
+    void setMaxConcurrentChecks(int count);
+    int maxConcurrentChecks() const;
+    // 附加的gcc参数（如强制包含的预置头文件）
+    void setExtraArguments(const QStringList &arguments);
+    // 关闭后不再自动检查，已有的检查照常完成
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    void addEditor(Editor *editor, const QString &fileName = QString());
+    void removeEditor(Editor *editor);
+    void setFileName(Editor *editor, const QString &fileName);
+    // 跳过等待立即检查，analyze为true时用-fanalyzer做静态分析
+    void checkNow(Editor *editor, bool analyze = false);
+
+signals:
+    void diagnosticsReady(Editor *editor, const QVector<Diagnostic> &diagnostics);
+
+private:
+    struct Job
+    {
+        QTimer *timer = nullptr;
+        QProcess *process = nullptr; // 正在运行的检查进程
+        QString fileName;
+        int generation = 0;          // 文档修改计数
+        int runningGeneration = -1;  // 正在检查的快照对应的修改计数
+        QByteArray runningKey;
+        bool analyze = false;        // 下一次检查是否做静态分析
+        bool queued = false;
+    };
+
+    void onContentsChanged(Editor *editor);
+    void enqueue(Editor *editor);
+    void startPending();
+    void startCheck(Editor *editor);
+    void onCheckFinished(Editor *editor, QProcess *process);
+    void cancelRunning(Job &job);
+    QStringList argumentsFor(bool analyze) const;
+
+    // 结果缓存容量（条）
+    static const int kCacheSize = 64;
+
+    QHash<Editor *, Job> m_jobs;
+    QList<Editor *> m_queue; // 等待空闲名额的编辑器
+    int m_running = 0;
+    int m_debounceMs;
+    int m_maxConcurrent;
+    bool m_enabled = true;
+    bool m_compilerMissing = false; // gcc无法启动时停止自动检查
+    bool m_byteColumns = false;     // gcc支持-fdiagnostics-column-unit=byte
+    QStringList m_extraArguments;
+    QCache<QByteArray, QVector<Diagnostic>> m_cache;
+};
+
+#endif // SYNTAXCHECKER_H
@@ -0,0 +1,438 @@
+#include "tccrunner.h"
+#include "processutil.h"
+#include <QSocketNotifier>
+#include <QTimer>
+
+#if defined(TINYIDE_HAVE_LIBTCC) && defined(Q_OS_UNIX)
+#define TCCRUNNER_ENABLED
+#include <libtcc.h>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// 轮询子进程是否退出的间隔（毫秒）
+static const int kPollIntervalMs = 10;
+// 每批最多读取输出的次数
+static const int kMaxReadsPerBatch = 16;
+
+#ifdef TCCRUNNER_ENABLED
+namespace
+{
+    // 子进程中使用：libtcc的错误回调，把诊断写入状态管道
+    void writeDiagnostic(void *opaque, const char *message)
+    {
+        int fd = *static_cast<int *>(opaque);
+        ssize_t ignored = write(fd, message, strlen(message));
+        ignored = write(fd, "\n", 1);
+        (void)ignored;
+    }
+
+    // 子进程中使用：替换程序调用的exit。真正的exit会执行从IDE继承的atexit处理函数和静态对象析构，
+    // 并冲刷fork前IDE自己缓冲的输出；这里只冲刷程序的输出后直接结束
+    [[noreturn]] void childExit(int status)
+    {
+        fflush(stdout);
+        fflush(stderr);
+        _exit(status);
+    }
+
+    // 子进程入口：编译、重定位、调用main，不返回
+    // fork之后只有当前线程存在，这里不使用任何Qt对象
+    [[noreturn]] void runChild(const char *source, int statusFd)
+    {
+        TCCState *state = tcc_new();
+        if (!state)
+            _exit(1);
+
+        tcc_set_error_func(state, &statusFd, writeDiagnostic);
+        tcc_set_output_type(state, TCC_OUTPUT_MEMORY);
+        if (tcc_compile_string(state, source) < 0)
+            _exit(1);
+        tcc_add_symbol(state, "exit", reinterpret_cast<const void *>(&childExit));
+#ifdef TCC_RELOCATE_AUTO
+        if (tcc_relocate(state, TCC_RELOCATE_AUTO) < 0)
+#else
+        if (tcc_relocate(state) < 0)
+#endif
+            _exit(1);
+
+        typedef int (*MainFunction)(int, char **);
+        MainFunction entry = reinterpret_cast<MainFunction>(tcc_get_symbol(state, "main"));
+        if (!entry)
+        {
+            writeDiagnostic(&statusFd, "error: 未找到main函数");
+            _exit(1);
+        }
+
+        // 通知父进程编译成功，之后的输出都属于程序本身
+        const char ready = '\0';
+        if (write(statusFd, &ready, 1) != 1)
+            _exit(1);
+        close(statusFd);
+
+        setvbuf(stdout, nullptr, _IONBF, 0);
+        char name[] = "program";
+        char *argv[] = {name, nullptr};
+        int result = entry(1, argv);
+        fflush(stdout);
+        fflush(stderr);
+        _exit(result);
+    }
+
+    void setNonBlocking(int fd)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    void closeFd(int &fd)
+    {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+}
+#endif
+
+TccRunner::TccRunner(QObject *parent)
+    : QObject(parent),
+      m_pollTimer(new QTimer(this))
+{
+    m_pollTimer->setInterval(kPollIntervalMs);
+    connect(m_pollTimer, &QTimer::timeout, this, &TccRunner::pollChild);
+}
+
+TccRunner::~TccRunner()
+{
+#ifdef TCCRUNNER_ENABLED
+    if (m_pid > 0)
+    {
+        kill(pid_t(m_pid), SIGKILL);
+        waitpid(pid_t(m_pid), nullptr, 0);
+    }
+#endif
+    closeChannels();
+}
+
+bool TccRunner::isSupported()
+{
+#ifdef TCCRUNNER_ENABLED
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool TccRunner::isRunning() const
+{
+    return m_pid > 0;
+}
+
+bool TccRunner::start(const QByteArray &source, const RunLimits &limits)
+{
+#ifdef TCCRUNNER_ENABLED
+    if (m_pid > 0)
+    {
+        kill(pid_t(m_pid), SIGKILL);
+        waitpid(pid_t(m_pid), nullptr, 0); // SIGKILL后子进程立即退出，回收不会阻塞
+        m_pid = -1;
+        m_pollTimer->stop();
+    }
+    closeChannels();
+
+    int input[2], output[2], status[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, input) != 0)
+        return false;
+    if (pipe2(output, O_CLOEXEC) != 0)
+    {
+        close(input[0]);
+        close(input[1]);
+        return false;
+    }
+    if (pipe2(status, O_CLOEXEC) != 0)
+    {
+        close(input[0]);
+        close(input[1]);
+        close(output[0]);
+        close(output[1]);
+        return false;
+    }
+
+    // 源码在fork前准备好，子进程只读取这块内存
+    // 子进程不exec，继承了IDE的全部地址空间，内存上限在fork时的占用之上计算；取不到占用时只限制CPU时间
+    const QByteArray program = source;
+    const qint64 addressSpace = RunLimits::currentAddressSpace();
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        for (int fd : {input[0], input[1], output[0], output[1], status[0], status[1]})
+            close(fd);
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        dup2(input[1], STDIN_FILENO);
+        dup2(output[1], STDOUT_FILENO);
+        dup2(output[1], STDERR_FILENO);
+        close(input[0]);
+        close(output[0]);
+        close(status[0]);
+        // CPU时间和内存限制都包含libtcc的编译，编译只占很小一部分
+        limits.applyToCurrentProcess(addressSpace);
+        runChild(program.constData(), status[1]);
+    }
+
+    close(input[1]);
+    close(output[1]);
+    close(status[1]);
+    m_pid = pid;
+    m_inputFd = input[0];
+    m_outputFd = output[0];
+    m_statusFd = status[0];
+    setNonBlocking(m_outputFd);
+    setNonBlocking(m_statusFd);
+    m_compiled = false;
+    m_stopRequested = false;
+    m_outputClosed = false;
+    m_diagnostics.clear();
+    m_clock.start();
+
+    m_outputNotifier = new QSocketNotifier(m_outputFd, QSocketNotifier::Read, this);
+    m_outputNotifier->setEnabled(!m_outputPaused);
+    connect(m_outputNotifier, &QSocketNotifier::activated, this, &TccRunner::onOutputReady);
+    m_statusNotifier = new QSocketNotifier(m_statusFd, QSocketNotifier::Read, this);
+    connect(m_statusNotifier, &QSocketNotifier::activated, this, &TccRunner::onStatusReady);
+    m_pollTimer->start();
+    return true;
+#else
+    Q_UNUSED(source)
+    Q_UNUSED(limits)
+    return false;
+#endif
+}
+
+void TccRunner::sendInput(const QByteArray &input)
+{
+#ifdef TCCRUNNER_ENABLED
+    if (m_inputFd < 0 || input.isEmpty())
+        return;
+
+    // 已有数据排队时追加在后面，保持写入顺序
+    m_pendingInput.append(input);
+    if (!m_inputNotifier || !m_inputNotifier->isEnabled())
+        writePendingInput();
+#else
+    Q_UNUSED(input)
+#endif
+}
+
+void TccRunner::onInputReady()
+{
+    writePendingInput();
+}
+
+// 写入排队的数据，写满时等待可写通知后继续；程序已退出或关闭标准输入时丢弃剩余数据
+void TccRunner::writePendingInput()
+{
+#ifdef TCCRUNNER_ENABLED
+    int offset = 0;
+    bool blocked = false;
+    while (offset < m_pendingInput.size())
+    {
+        ssize_t written = send(m_inputFd, m_pendingInput.constData() + offset,
+                               size_t(m_pendingInput.size() - offset), MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (written > 0)
+        {
+            offset += int(written);
+            continue;
+        }
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            blocked = true;
+        else
+            offset = m_pendingInput.size();
+        break;
+    }
+    m_pendingInput.remove(0, offset);
+
+    if (blocked && !m_inputNotifier)
+    {
+        m_inputNotifier = new QSocketNotifier(m_inputFd, QSocketNotifier::Write, this);
+        connect(m_inputNotifier, &QSocketNotifier::activated, this, &TccRunner::onInputReady);
+    }
+    if (m_inputNotifier)
+        m_inputNotifier->setEnabled(blocked);
+#endif
+}
+
+void TccRunner::setOutputPaused(bool paused)
+{
+    m_outputPaused = paused;
+    // 输出已关闭时通知器保持禁用
+    if (m_outputNotifier && !m_outputClosed)
+        m_outputNotifier->setEnabled(!paused);
+}
+
+void TccRunner::stop()
+{
+#ifdef TCCRUNNER_ENABLED
+    if (m_pid <= 0)
+        return;
+
+    const qint64 pid = m_pid;
+    m_stopRequested = true;
+    kill(pid_t(pid), SIGTERM);
+    QTimer::singleShot(ProcessUtil::kTerminateGraceMs, this, [this, pid]()
+                       {
+        if (m_pid == pid)
+            kill(pid_t(pid), SIGKILL); });
+#endif
+}
+
+// 程序输出
+// 每次通知最多读取固定次数，输出不断时也能回到事件循环，剩余数据由下一次通知读取
+void TccRunner::onOutputReady()
+{
+    readOutput();
+}
+
+// 读取一批输出，返回是否可能还有未读的数据；读取中途被暂停时立即返回，剩余数据留在管道中
+bool TccRunner::readOutput()
+{
+#ifdef TCCRUNNER_ENABLED
+    char buffer[65536];
+    for (int i = 0; i < kMaxReadsPerBatch; ++i)
+    {
+        ssize_t n = read(m_outputFd, buffer, sizeof(buffer));
+        if (n > 0)
+        {
+            emit runOutput(QByteArray(buffer, int(n)));
+            if (m_outputPaused)
+                return true;
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EINTR))
+        {
+            m_outputClosed = true;
+            m_outputNotifier->setEnabled(false); // 写端已关闭
+        }
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+// 编译诊断，读到'\0'表示编译成功
+void TccRunner::onStatusReady()
+{
+#ifdef TCCRUNNER_ENABLED
+    char buffer[1024];
+    for (;;)
+    {
+        ssize_t n = read(m_statusFd, buffer, sizeof(buffer));
+        if (n > 0)
+        {
+            const char *end = static_cast<const char *>(memchr(buffer, '\0', size_t(n)));
+            m_diagnostics.append(buffer, end ? int(end - buffer) : int(n));
+            if (end && !m_compiled)
+            {
+                m_compiled = true;
+                emit compileFinished(true, QString::fromLocal8Bit(m_diagnostics));
+                emit runStarted();
+            }
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EINTR))
+            m_statusNotifier->setEnabled(false);
+        break;
+    }
+#endif
+}
+
+// 检查子进程是否已退出，同时读完剩余输出
+void TccRunner::pollChild()
+{
+#ifdef TCCRUNNER_ENABLED
+    if (m_pid <= 0)
+        return;
+
+    int status = 0;
+    struct rusage resources;
+    pid_t result = wait4(pid_t(m_pid), &status, WNOHANG, &resources);
+    if (result == 0 || (result < 0 && errno == EINTR))
+        return;
+
+    RunUsage usage;
+    usage.wallMs = m_clock.nsecsElapsed() / 1e6;
+    if (result > 0)
+        usage.setResourceUsage(resources);
+
+    onStatusReady();
+    while (readOutput())
+    {
+    }
+    finish(status, usage);
+#endif
+}
+
+void TccRunner::finish(int status, const RunUsage &usage)
+{
+#ifdef TCCRUNNER_ENABLED
+    m_pid = -1;
+    m_pollTimer->stop();
+    closeChannels();
+
+    if (!m_compiled)
+    {
+        emit compileFinished(false, QString::fromLocal8Bit(m_diagnostics));
+        return;
+    }
+
+    if (m_stopRequested)
+    {
+        emit runFinished(-1, true, "程序已被用户终止", usage);
+    }
+    else if (WIFSIGNALED(status))
+    {
+        int signal = WTERMSIG(status);
+        if (signal == SIGXCPU)
+            emit runFinished(-1, true, "程序超过CPU时间限制，已被终止", usage);
+        else
+            emit runFinished(-1, true, QString("程序被信号%1（%2）终止").arg(signal).arg(strsignal(signal)), usage);
+    }
+    else
+    {
+        int exitCode = WEXITSTATUS(status);
+        emit runFinished(exitCode, false, QString("程序运行结束\n退出代码: %1\n").arg(exitCode), usage);
+    }
+#else
+    Q_UNUSED(status)
+    Q_UNUSED(usage)
+#endif
+}
+
+void TccRunner::closeChannels()
+{
+    delete m_outputNotifier;
+    m_outputNotifier = nullptr;
+    delete m_statusNotifier;
+    m_statusNotifier = nullptr;
+    delete m_inputNotifier;
+    m_inputNotifier = nullptr;
+    m_pendingInput.clear();
+#ifdef TCCRUNNER_ENABLED
+    closeFd(m_inputFd);
+    closeFd(m_outputFd);
+    closeFd(m_statusFd);
+#endif
+}
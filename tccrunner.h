@@ -0,0 +1,73 @@
+#ifndef TCCRUNNER_H
+#define TCCRUNNER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include "runlimits.h"
+
+class QSocketNotifier;
+class QTimer;
+
+// 内存中编译运行：fork出子进程，在子进程中用libtcc把源码直接编译到内存并调用main，
+// 不启动编译器进程、不写临时文件、不链接可执行文件；程序崩溃只影响子进程
+// 需要以CONFIG+=tinyide_libtcc构建（定义TINYIDE_HAVE_LIBTCC并链接libtcc），且仅支持Unix
+class TccRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TccRunner(QObject *parent = nullptr);
+    ~TccRunner() override;
+
+    // 当前构建和平台是否支持
+    static bool isSupported();
+
+    // 编译并运行source（以'\0'结尾的C源码），正在运行的程序会先被结束
+    bool start(const QByteArray &source, const RunLimits &limits = RunLimits());
+    bool isRunning() const;
+    // 写入标准输入；程序暂时读不完的部分排队，可写时继续写入，不阻塞界面线程
+    void sendInput(const QByteArray &input);
+    // 暂停或恢复读取输出：暂停期间程序写满管道后阻塞，输出不会丢失；程序退出时照常读完
+    void setOutputPaused(bool paused);
+    // 先SIGTERM，宽限期后SIGKILL
+    void stop();
+
+signals:
+    // 编译结束，diagnostics为libtcc报告的错误和警告文本
+    void compileFinished(bool success, const QString &diagnostics);
+    void runStarted();
+    // 程序输出的原始字节（标准输出和标准错误合并）
+    void runOutput(const QByteArray &data);
+    void runFinished(int exitCode, bool crashed, const QString &message, const RunUsage &usage);
+
+private slots:
+    void onOutputReady();
+    void onInputReady();
+    void onStatusReady();
+    void pollChild();
+
+private:
+    bool readOutput();
+    void writePendingInput();
+    void closeChannels();
+    void finish(int status, const RunUsage &usage);
+
+    qint64 m_pid = -1;
+    int m_inputFd = -1;  // 子进程标准输入（socketpair，写入时不触发SIGPIPE）
+    int m_outputFd = -1; // 子进程标准输出和标准错误
+    int m_statusFd = -1; // 编译诊断，以'\0'表示编译成功、开始运行
+    bool m_compiled = false;
+    bool m_stopRequested = false;
+    bool m_outputPaused = false;
+    bool m_outputClosed = false;
+    QByteArray m_diagnostics;
+    QByteArray m_pendingInput; // 尚未写入标准输入的数据
+    QSocketNotifier *m_outputNotifier = nullptr;
+    QSocketNotifier *m_inputNotifier = nullptr; // 有待写数据时等待标准输入可写
+    QSocketNotifier *m_statusNotifier = nullptr;
+    QElapsedTimer m_clock;
+    QTimer *m_pollTimer;
+};
+
+#endif // TCCRUNNER_H
@@ -0,0 +1,55 @@
+QT       += core gui widgets testlib
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_benchmarks
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_benchmarks.cpp \
+    ../../benchmark.cpp \
+    ../../buildprofile.cpp \
+    ../../clexer.cpp \
+    ../../compilecache.cpp \
+    ../../compiler.cpp \
+    ../../compilerbackend.cpp \
+    ../../diagnostics.cpp \
+    ../../outputcollector.cpp \
+    ../../outputconsole.cpp \
+    ../../pchcache.cpp \
+    ../../processutil.cpp \
+    ../../runlimits.cpp \
+    ../../runprocess.cpp \
+    ../../tccrunner.cpp \
+    ../../textsearch.cpp
+
+HEADERS += \
+    ../../benchmark.h \
+    ../../buildprofile.h \
+    ../../clexer.h \
+    ../../compilecache.h \
+    ../../compiler.h \
+    ../../compilerbackend.h \
+    ../../diagnostics.h \
+    ../../outputcollector.h \
+    ../../outputconsole.h \
+    ../../pchcache.h \
+    ../../processutil.h \
+    ../../runlimits.h \
+    ../../runprocess.h \
+    ../../tccrunner.h \
+    ../../textsearch.h
+
+# 伪终端（forkpty）所在的库
+unix:!macx {
+    LIBS += -lutil
+}
+
+# 与TinyIDE.pro相同的libtcc选项：qmake CONFIG+=tinyide_libtcc tests/tests.pro，
+# 同时检查内存编译运行的代码能否编译链接
+tinyide_libtcc:unix {
+    DEFINES += TINYIDE_HAVE_LIBTCC
+    LIBS += -ltcc -ldl
+}
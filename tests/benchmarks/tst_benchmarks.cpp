@@ -0,0 +1,409 @@
+#include <QtTest>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QSyntaxHighlighter>
+#include <QTemporaryDir>
+#include <QTextCharFormat>
+#include <QTextDocument>
+#include "clexer.h"
+#include "compiler.h"
+#include "outputcollector.h"
+#include "outputconsole.h"
+#include "textsearch.h"
+
+// 基准测试；无显示环境下用QT_QPA_PLATFORM=offscreen运行
+// 每行数据的每秒处理量由"行数 / 每次迭代耗时"得出，运行时同时打印
+
+namespace
+{
+    // 有代表性的C代码：关键字、函数调用、字符串、字符、数字、行注释和跨行块注释
+    QString sampleSource(int lines)
+    {
+        static const char *const snippet[] = {
+            "#include <stdio.h>",
+            "/* 计算数组元素之和",
+            "   跨行的块注释 */",
+            "static int sum(const int *values, unsigned long count)",
+            "{",
+            "    int total = 0; // 累加结果",
+            "    for (unsigned long i = 0; i < count; ++i)",
+            "        total += values[i] * 0x1F + 3.25;",
+            "    printf(\"sum = %d, \\\"quoted\\\"\\n\", total);",
+            "    char c = '\\'';",
+            "    return total;",
+            "}",
+        };
+        const int snippetLines = int(sizeof(snippet) / sizeof(snippet[0]));
+
+        QStringList text;
+        for (int i = 0; i < lines; ++i)
+            text << QString::fromUtf8(snippet[i % snippetLines]);
+        return text.join('\n');
+    }
+
+    // 改动前的高亮方式：每条规则对每行执行一次globalMatch
+    class RegexHighlighter : public QSyntaxHighlighter
+    {
+    public:
+        explicit RegexHighlighter(QTextDocument *document)
+            : QSyntaxHighlighter(document)
+        {
+            QTextCharFormat format;
+            format.setForeground(Qt::darkBlue);
+            const char *const keywords[] = {
+                "char", "class", "const", "double", "enum", "explicit", "friend", "inline", "int",
+                "long", "namespace", "operator", "private", "protected", "public", "short", "signals",
+                "signed", "slots", "static", "struct", "template", "typedef", "typename", "union",
+                "unsigned", "virtual", "void", "volatile", "bool", "if", "else", "switch", "case",
+                "default", "for", "while", "do", "return", "break", "continue", "delete", "new", "this",
+                "sizeof", "true", "false"};
+            for (const char *keyword : keywords)
+                m_rules.append({QRegularExpression(QString("\\b%1\\b").arg(QLatin1String(keyword))), format});
+            m_rules.append({QRegularExpression("\\bQ[A-Za-z]+\\b"), format});
+            m_rules.append({QRegularExpression("\\b[A-Za-z0-9_]+(?=\\()"), format});
+            m_rules.append({QRegularExpression("\".*\""), format});
+            m_rules.append({QRegularExpression("'.*'"), format});
+            m_rules.append({QRegularExpression("\\b[0-9]+\\b"), format});
+            m_rules.append({QRegularExpression("\\b0x[0-9A-Fa-f]+\\b"), format});
+            m_rules.append({QRegularExpression("\\b[0-9]+\\.[0-9]+\\b"), format});
+            m_rules.append({QRegularExpression("//[^\n]*"), format});
+            m_commentStart = QRegularExpression("/\\*");
+            m_commentEnd = QRegularExpression("\\*/");
+            m_commentFormat.setForeground(Qt::gray);
+        }
+
+    protected:
+        void highlightBlock(const QString &text) override
+        {
+            for (const Rule &rule : qAsConst(m_rules))
+            {
+                QRegularExpressionMatchIterator matches = rule.pattern.globalMatch(text);
+                while (matches.hasNext())
+                {
+                    QRegularExpressionMatch match = matches.next();
+                    setFormat(match.capturedStart(), match.capturedLength(), rule.format);
+                }
+            }
+
+            setCurrentBlockState(0);
+            int start = previousBlockState() == 1 ? 0 : text.indexOf(m_commentStart);
+            while (start >= 0)
+            {
+                QRegularExpressionMatch match = m_commentEnd.match(text, start);
+                int end = match.capturedStart();
+                int length;
+                if (end == -1)
+                {
+                    setCurrentBlockState(1);
+                    length = text.length() - start;
+                }
+                else
+                {
+                    length = end - start + match.capturedLength();
+                }
+                setFormat(start, length, m_commentFormat);
+                start = text.indexOf(m_commentStart, start + length);
+            }
+        }
+
+    private:
+        struct Rule
+        {
+            QRegularExpression pattern;
+            QTextCharFormat format;
+        };
+        QVector<Rule> m_rules;
+        QRegularExpression m_commentStart;
+        QRegularExpression m_commentEnd;
+        QTextCharFormat m_commentFormat;
+    };
+
+    // 改动后的高亮方式：与EditorSyntaxHighlighter相同，每行用CLexer单遍分词后按词法单元设置格式
+    class LexerHighlighter : public QSyntaxHighlighter
+    {
+    public:
+        explicit LexerHighlighter(QTextDocument *document)
+            : QSyntaxHighlighter(document)
+        {
+            m_format.setForeground(Qt::darkBlue);
+        }
+
+    protected:
+        void highlightBlock(const QString &text) override
+        {
+            setCurrentBlockState(CLexer::tokenize(text, qMax(previousBlockState(), 0), m_tokens));
+            for (const CLexer::Token &token : qAsConst(m_tokens))
+            {
+                if (token.type != CLexer::Bracket)
+                    setFormat(token.start, token.length, m_format);
+            }
+        }
+
+    private:
+        QVector<CLexer::Token> m_tokens;
+        QTextCharFormat m_format;
+    };
+
+    void reportRate(const char *what, double units, qint64 nsecs, const char *unit)
+    {
+        if (nsecs > 0)
+            qInfo("%s: %.0f %s/s", what, units * 1e9 / nsecs, unit);
+    }
+
+    // 每次编译的源码都不同（常量取不同的值），编译缓存不会命中
+    QString compileRunSource(int serial)
+    {
+        return QString("#include <stdio.h>\n"
+                       "int main(void)\n"
+                       "{\n"
+                       "    printf(\"%d\\n\", %1);\n"
+                       "    return 0;\n"
+                       "}\n")
+            .arg(serial);
+    }
+
+    // 环境检查：gcc能否静态链接一个最简单的程序（很多系统没有装静态C运行库）
+    bool canLinkStatically()
+    {
+        QTemporaryDir dir;
+        QProcess gcc;
+        gcc.start("gcc", QStringList() << "-static" << "-x" << "c" << "-" << "-o" << dir.filePath("probe"));
+        gcc.write("int main(void) { return 0; }\n");
+        gcc.closeWriteChannel();
+        return gcc.waitForFinished(30000) && gcc.exitStatus() == QProcess::NormalExit && gcc.exitCode() == 0;
+    }
+}
+
+class BenchmarkTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void highlighting_data();
+    void highlighting();
+    void search_data();
+    void search();
+    void compileAndRun_data();
+    void compileAndRun();
+    void outputStream();
+};
+
+// 整个文档重新高亮的耗时：改动前（正则规则）与改动后（CLexer）
+void BenchmarkTest::highlighting_data()
+{
+    QTest::addColumn<bool>("lexer");
+    QTest::newRow("regex rules") << false;
+    QTest::newRow("CLexer") << true;
+}
+
+void BenchmarkTest::highlighting()
+{
+    QFETCH(bool, lexer);
+    const int lines = 20000;
+    QTextDocument document(sampleSource(lines));
+    QScopedPointer<QSyntaxHighlighter> highlighter;
+    if (lexer)
+        highlighter.reset(new LexerHighlighter(&document));
+    else
+        highlighter.reset(new RegexHighlighter(&document));
+
+    QElapsedTimer timer;
+    timer.start();
+    highlighter->rehighlight();
+    reportRate(QTest::currentDataTag(), lines, timer.nsecsElapsed(), "lines");
+
+    QBENCHMARK
+    {
+        highlighter->rehighlight();
+    }
+}
+
+// 多兆字节文本中查找全部匹配：TextSearch的各个实现与QString::indexOf比较
+void BenchmarkTest::search_data()
+{
+    QTest::addColumn<QString>("kernel"); // 为空时使用QString::indexOf
+    QTest::addColumn<QString>("needle");
+    QTest::addColumn<bool>("caseInsensitive");
+
+    const QStringList kernels = {"avx2", "sse2", "scalar", QString()};
+    const QStringList needles = {"values[i] * 0x1F", "no_such_identifier"};
+    for (const QString &kernel : kernels)
+    {
+        for (const QString &needle : needles)
+        {
+            for (bool caseInsensitive : {false, true})
+            {
+                QString tag = QString("%1 %2 %3")
+                                  .arg(kernel.isEmpty() ? "QString::indexOf" : kernel)
+                                  .arg(needle)
+                                  .arg(caseInsensitive ? "ci" : "cs");
+                QTest::newRow(tag.toUtf8().constData()) << kernel << needle << caseInsensitive;
+            }
+        }
+    }
+}
+
+void BenchmarkTest::search()
+{
+    QFETCH(QString, kernel);
+    QFETCH(QString, needle);
+    QFETCH(bool, caseInsensitive);
+
+    static const QString text = sampleSource(200000); // 约500万字符（10 MB）
+    const Qt::CaseSensitivity sensitivity = caseInsensitive ? Qt::CaseInsensitive : Qt::CaseSensitive;
+    int expected = 0;
+    for (int pos = text.indexOf(needle, 0, sensitivity); pos != -1;
+         pos = text.indexOf(needle, pos + needle.length(), sensitivity))
+        ++expected;
+
+    if (!kernel.isEmpty() && !TextSearch::setKernel(kernel))
+        QSKIP("当前CPU不支持该实现");
+    TextSearch search(needle, caseInsensitive ? TextSearch::CaseInsensitive : TextSearch::NoOptions);
+
+    auto countMatches = [&]()
+    {
+        if (!kernel.isEmpty())
+            return search.findAll(text).size();
+        int count = 0;
+        for (int pos = text.indexOf(needle, 0, sensitivity); pos != -1;
+             pos = text.indexOf(needle, pos + needle.length(), sensitivity))
+            ++count;
+        return count;
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    int count = countMatches();
+    reportRate(QTest::currentDataTag(), text.size() * 2.0 / (1024 * 1024), timer.nsecsElapsed(), "MB");
+    QCOMPARE(count, expected);
+
+    QBENCHMARK
+    {
+        count = countMatches();
+    }
+    TextSearch::setKernel(TextSearch::availableKernels().first());
+}
+
+// 从点击"编译并运行"到程序结束的端到端耗时：libtcc内存编译运行与gcc静态链接后运行比较
+void BenchmarkTest::compileAndRun_data()
+{
+    QTest::addColumn<bool>("inMemory");
+    QTest::newRow("gcc -static") << false;
+    QTest::newRow("libtcc") << true;
+}
+
+void BenchmarkTest::compileAndRun()
+{
+    QFETCH(bool, inMemory);
+    if (inMemory && !Compiler::isInMemoryRunSupported())
+        QSKIP("未以CONFIG+=tinyide_libtcc构建");
+    if (!inMemory && QStandardPaths::findExecutable("gcc").isEmpty())
+        QSKIP("未找到gcc");
+    if (!inMemory && !canLinkStatically())
+        QSKIP("gcc无法静态链接（缺少静态C运行库）");
+    QStandardPaths::setTestModeEnabled(true);
+
+    Compiler compiler;
+    BuildProfile profile;
+    profile.linkage = BuildProfile::StaticLinkage;
+    compiler.setBuildProfile(profile);
+    compiler.setRunMode(Compiler::BenchmarkRun);
+    QSignalSpy compiled(&compiler, &Compiler::compileFinished);
+    QSignalSpy finished(&compiler, &Compiler::runFinished);
+
+    // 编译并运行一次，返回失败原因（编译或运行的输出），成功时为空
+    static int serial = 0;
+    auto compileAndRunOnce = [&]() -> QString
+    {
+        compiled.clear();
+        finished.clear();
+        const QString source = compileRunSource(++serial);
+        if (inMemory)
+        {
+            if (!compiler.runInMemory(source, "bench.c"))
+                return QStringLiteral("无法启动内存运行");
+        }
+        else
+        {
+            compiler.compile(source, "bench.c");
+        }
+        // libtcc编译失败时只报告编译结束，不再报告运行结束
+        if (compiled.isEmpty() && !compiled.wait(30000))
+            return QStringLiteral("编译超时");
+        if (!compiled.first().at(0).toBool())
+            return compiled.first().at(1).toString();
+        if (!inMemory)
+            compiler.runProgram();
+        if (finished.isEmpty() && !finished.wait(30000))
+            return QStringLiteral("运行超时");
+        if (!finished.first().at(0).toBool())
+            return finished.first().at(1).toString();
+        return QString();
+    };
+
+    // 第一次运行同时等待预编译头生成，不计入耗时
+    QString error = compileAndRunOnce();
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+
+    QElapsedTimer timer;
+    timer.start();
+    error = compileAndRunOnce();
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    reportRate(QTest::currentDataTag(), 1, timer.nsecsElapsed(), "runs");
+
+    QBENCHMARK
+    {
+        error = compileAndRunOnce();
+        QVERIFY2(error.isEmpty(), qPrintable(error));
+    }
+}
+
+// 程序以约100 MB/s的速度连续输出时，经OutputCollector到OutputConsole的实际显示吞吐量：
+// 模拟的输出来源每毫秒写入100 KB，收到暂停通知后停止写入（相当于子进程阻塞在管道上）
+void BenchmarkTest::outputStream()
+{
+    const QByteArray line = QByteArray(79, 'x') + '\n';
+    const QByteArray chunk = line.repeated(1280); // 100 KB
+    const qint64 totalBytes = 1024LL * chunk.size(); // 100 MB
+
+    OutputConsole console;
+    console.resize(800, 600);
+    console.show();
+    OutputCollector collector;
+    qint64 received = 0;
+    connect(&collector, &OutputCollector::outputReady, &console, [&](const QString &text)
+            {
+        received += text.size();
+        console.insertText(text); });
+
+    bool paused = false;
+    qint64 sent = 0;
+    QTimer source;
+    source.setTimerType(Qt::PreciseTimer);
+    source.setInterval(1);
+    connect(&collector, &OutputCollector::backpressureChanged, [&](bool value) { paused = value; });
+    connect(&source, &QTimer::timeout, [&]()
+            {
+        if (paused)
+            return;
+        collector.append(chunk);
+        sent += chunk.size();
+        if (sent >= totalBytes)
+            source.stop(); });
+
+    QBENCHMARK_ONCE
+    {
+        QElapsedTimer timer;
+        timer.start();
+        collector.start();
+        source.start();
+        QTRY_COMPARE_WITH_TIMEOUT(received, totalBytes, 120000);
+        reportRate(QTest::currentTestFunction(), totalBytes / (1024.0 * 1024), timer.nsecsElapsed(), "MB");
+    }
+    QCOMPARE(collector.stats().droppedBytes, qint64(0));
+}
+
+QTEST_MAIN(BenchmarkTest)
+
+#include "tst_benchmarks.moc"
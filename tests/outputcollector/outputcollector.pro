@@ -0,0 +1,16 @@
+QT       += core testlib
+QT       -= gui
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_outputcollector
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_outputcollector.cpp \
+    ../../outputcollector.cpp
+
+HEADERS += \
+    ../../outputcollector.h
@@ -0,0 +1,138 @@
+#include <QtTest>
+#include "outputcollector.h"
+
+// 环形缓冲区的回绕、扩容和溢出丢弃：用很小的容量让每种情况都能用几个字节触发
+
+namespace
+{
+    // 测试用的小容量（字节）
+    const int kCapacity = 16;
+
+    // 等待定时发出，返回期间发出的全部文本
+    QString waitForOutput(QSignalSpy &spy)
+    {
+        if (spy.isEmpty() && !spy.wait(1000))
+            return QString();
+        QString text;
+        for (const QList<QVariant> &arguments : spy)
+            text += arguments.at(0).toString();
+        spy.clear();
+        return text;
+    }
+}
+
+class OutputCollectorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void wrapAround();
+    void growWhileWrapped();
+    void dropWhenUnpausable();
+    void dropOversizedAppend();
+    void drainWithinBudget();
+};
+
+// 写入位置越过缓冲区末尾时回到开头，发出的内容保持原有顺序
+void OutputCollectorTest::wrapAround()
+{
+    OutputCollector collector(nullptr, kCapacity);
+    QSignalSpy output(&collector, &OutputCollector::outputReady);
+    QSignalSpy backpressure(&collector, &OutputCollector::backpressureChanged);
+    collector.start();
+
+    collector.append(QByteArray("0123456789"));
+    QCOMPARE(waitForOutput(output), QString("0123456789"));
+    collector.append(QByteArray("abcdefghij")); // 前6个字节在末尾，后4个回到开头
+    QCOMPARE(waitForOutput(output), QString("abcdefghij"));
+    collector.append(QByteArray("ABCDEFGHIJ"));
+    QCOMPARE(waitForOutput(output), QString("ABCDEFGHIJ"));
+
+    QVERIFY(backpressure.isEmpty());
+    QCOMPARE(collector.stats().bytes, qint64(30));
+}
+
+// 数据已回绕时超过容量：请求暂停，扩容后按顺序保留全部数据，发出后恢复
+void OutputCollectorTest::growWhileWrapped()
+{
+    OutputCollector collector(nullptr, kCapacity);
+    QSignalSpy output(&collector, &OutputCollector::outputReady);
+    QSignalSpy backpressure(&collector, &OutputCollector::backpressureChanged);
+    collector.start();
+
+    collector.append(QByteArray("0123456789"));
+    QCOMPARE(waitForOutput(output), QString("0123456789"));
+    collector.append(QByteArray("abcdefghij"));
+    collector.append(QByteArray("ABCDEFGHIJKLMNOPQRST"));
+    QCOMPARE(backpressure.count(), 1);
+    QCOMPARE(backpressure.first().at(0).toBool(), true);
+
+    QCOMPARE(waitForOutput(output), QString("abcdefghijABCDEFGHIJKLMNOPQRST"));
+    QCOMPARE(backpressure.count(), 2);
+    QCOMPARE(backpressure.last().at(0).toBool(), false);
+    QCOMPARE(collector.stats().droppedBytes, qint64(0));
+}
+
+// 无法暂停的来源：不扩容，丢弃最旧的字节，发出时在剩余内容前插入提示
+void OutputCollectorTest::dropWhenUnpausable()
+{
+    OutputCollector collector(nullptr, kCapacity);
+    QSignalSpy output(&collector, &OutputCollector::outputReady);
+    QSignalSpy backpressure(&collector, &OutputCollector::backpressureChanged);
+    collector.start();
+    collector.setPausable(false);
+
+    collector.append(QByteArray("0123456789"));
+    collector.append(QByteArray("abcdefghij"));
+    QCOMPARE(waitForOutput(output), QString("\n[输出过快，已省略 4 字节]\n456789abcdefghij"));
+
+    // 丢弃后继续回绕写入
+    collector.append(QByteArray("ABCDEFGHIJ"));
+    QCOMPARE(waitForOutput(output), QString("ABCDEFGHIJ"));
+
+    QVERIFY(backpressure.isEmpty());
+    QCOMPARE(collector.stats().droppedBytes, qint64(4));
+
+    // 新的一次运行恢复为可暂停
+    collector.start();
+    collector.append(QByteArray("0123456789abcdefghij"));
+    QCOMPARE(backpressure.count(), 1);
+    QCOMPARE(waitForOutput(output), QString("0123456789abcdefghij"));
+}
+
+// 无法暂停时单次写入超过容量：只保留末尾部分
+void OutputCollectorTest::dropOversizedAppend()
+{
+    OutputCollector collector(nullptr, kCapacity);
+    QSignalSpy output(&collector, &OutputCollector::outputReady);
+    collector.start();
+    collector.setPausable(false);
+
+    collector.append(QByteArray("xyz"));
+    collector.append(QByteArray("0123456789abcdefghijABCDEFGHIJ"));
+    QCOMPARE(waitForOutput(output), QString("\n[输出过快，已省略 17 字节]\nefghijABCDEFGHIJ"));
+    QCOMPARE(collector.stats().droppedBytes, qint64(17));
+}
+
+// 一次定时发出不限于一块：界面处理得快时，时间预算内连续发出多块
+void OutputCollectorTest::drainWithinBudget()
+{
+    OutputCollector collector;
+    QSignalSpy output(&collector, &OutputCollector::outputReady);
+    collector.start();
+
+    const QByteArray data(4 * OutputCollector::kFlushChunkBytes, 'x');
+    collector.append(data);
+    QVERIFY(output.wait(1000));
+    QVERIFY2(output.count() > 1, qPrintable(QString("一次只发出了 %1 块").arg(output.count())));
+
+    collector.finish();
+    int received = 0;
+    for (const QList<QVariant> &arguments : output)
+        received += arguments.at(0).toString().size();
+    QCOMPARE(received, data.size());
+}
+
+QTEST_GUILESS_MAIN(OutputCollectorTest)
+
+#include "tst_outputcollector.moc"
@@ -0,0 +1,43 @@
+QT       += core testlib
+QT       -= gui
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_pipeline
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_pipeline.cpp \
+    ../../benchmark.cpp \
+    ../../buildprofile.cpp \
+    ../../compilecache.cpp \
+    ../../compiler.cpp \
+    ../../compilerbackend.cpp \
+    ../../diagnostics.cpp \
+    ../../outputcollector.cpp \
+    ../../pchcache.cpp \
+    ../../processutil.cpp \
+    ../../runlimits.cpp \
+    ../../runprocess.cpp \
+    ../../tccrunner.cpp
+
+HEADERS += \
+    ../../benchmark.h \
+    ../../buildprofile.h \
+    ../../compilecache.h \
+    ../../compiler.h \
+    ../../compilerbackend.h \
+    ../../diagnostics.h \
+    ../../outputcollector.h \
+    ../../pchcache.h \
+    ../../processutil.h \
+    ../../runlimits.h \
+    ../../runprocess.h \
+    ../../tccrunner.h
+
+# 伪终端（forkpty）所在的库
+unix:!macx {
+    LIBS += -lutil
+}
@@ -0,0 +1,223 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include "compiler.h"
+#include "processutil.h"
+
+// 编译/运行流程不阻塞事件循环：用1毫秒间隔的心跳计时器测量事件循环的最大停顿，
+// 同时测量各个入口函数本身的耗时。需要gcc，没有时跳过
+
+namespace
+{
+    // 允许的最长停顿（毫秒）：比"几毫秒"宽松一些，留出测试机负载造成的调度抖动
+    const qint64 kMaxStallMs = 20;
+
+    const char kHelloSource[] =
+        "#include <stdio.h>\n"
+        "int main(void)\n"
+        "{\n"
+        "    printf(\"hello\\n\");\n"
+        "    return 0;\n"
+        "}\n";
+
+    // 忽略SIGTERM、永不退出的程序：只能靠宽限期后的SIGKILL结束
+    const char kStubbornSource[] =
+        "#include <signal.h>\n"
+        "#include <stdio.h>\n"
+        "#include <unistd.h>\n"
+        "int main(void)\n"
+        "{\n"
+        "    signal(SIGTERM, SIG_IGN);\n"
+        "    printf(\"ready\\n\");\n"
+        "    fflush(stdout);\n"
+        "    for (;;)\n"
+        "        pause();\n"
+        "}\n";
+
+    // 事件循环心跳：记录相邻两次计时器触发之间的最大间隔
+    class Heartbeat : public QObject
+    {
+    public:
+        Heartbeat()
+        {
+            m_timer.setInterval(1);
+            m_timer.setTimerType(Qt::PreciseTimer);
+            connect(&m_timer, &QTimer::timeout, this, [this]()
+                    {
+                qint64 now = m_clock.nsecsElapsed();
+                m_maxGapNs = qMax(m_maxGapNs, now - m_lastNs);
+                m_lastNs = now; });
+        }
+
+        void start()
+        {
+            m_maxGapNs = 0;
+            m_lastNs = 0;
+            m_clock.start();
+            m_timer.start();
+        }
+
+        // 停止并返回最大间隔（毫秒），包括最后一次触发到现在的间隔
+        double stop()
+        {
+            m_timer.stop();
+            m_maxGapNs = qMax(m_maxGapNs, m_clock.nsecsElapsed() - m_lastNs);
+            return m_maxGapNs / 1e6;
+        }
+
+    private:
+        QTimer m_timer;
+        QElapsedTimer m_clock;
+        qint64 m_lastNs = 0;
+        qint64 m_maxGapNs = 0;
+    };
+
+    // 调用本身的耗时（毫秒）
+    template <typename Function>
+    double timeCall(Function function)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        function();
+        return timer.nsecsElapsed() / 1e6;
+    }
+}
+
+class PipelineTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void compileAndRun();
+    void cancelCompile();
+    void stopIgnoringSigterm();
+    void destroyWhileRunning();
+
+private:
+    bool compileSource(Compiler *compiler, const char *source);
+};
+
+void PipelineTest::initTestCase()
+{
+    if (QStandardPaths::findExecutable("gcc").isEmpty())
+        QSKIP("未找到gcc");
+    // 编译缓存和预编译头写到测试专用目录
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+// 编译并等待结束，期间事件循环不能停顿
+bool PipelineTest::compileSource(Compiler *compiler, const char *source)
+{
+    QSignalSpy finished(compiler, &Compiler::compileFinished);
+    Heartbeat heartbeat;
+    heartbeat.start();
+    double callMs = timeCall([&]()
+                             { compiler->compile(QString::fromUtf8(source), "test.c"); });
+    bool done = finished.count() > 0 || finished.wait(30000);
+    double stallMs = heartbeat.stop();
+
+    if (callMs > kMaxStallMs || stallMs > kMaxStallMs)
+        qWarning("compile(): 调用 %.1f ms，最大停顿 %.1f ms", callMs, stallMs);
+    [&]()
+    {
+        QVERIFY2(done, "编译未结束");
+        QVERIFY2(finished.first().at(0).toBool(), qPrintable(finished.first().at(1).toString()));
+        QVERIFY(callMs <= kMaxStallMs);
+        QVERIFY(stallMs <= kMaxStallMs);
+    }();
+    return !QTest::currentTestFailed();
+}
+
+void PipelineTest::compileAndRun()
+{
+    Compiler compiler;
+    if (!compileSource(&compiler, kHelloSource))
+        return;
+
+    QSignalSpy finished(&compiler, &Compiler::runFinished);
+    Heartbeat heartbeat;
+    heartbeat.start();
+    double callMs = timeCall([&]()
+                             { compiler.runProgram(); });
+    QVERIFY(finished.count() > 0 || finished.wait(10000));
+    double stallMs = heartbeat.stop();
+
+    QVERIFY2(finished.first().at(0).toBool(), qPrintable(finished.first().at(1).toString()));
+    QVERIFY2(callMs <= kMaxStallMs, qPrintable(QString("runProgram() %1 ms").arg(callMs)));
+    QVERIFY2(stallMs <= kMaxStallMs, qPrintable(QString("最大停顿 %1 ms").arg(stallMs)));
+}
+
+// 编译进行中再次编译：旧的编译被取消，不等待其退出，只报告新的一次
+void PipelineTest::cancelCompile()
+{
+    Compiler compiler;
+    QSignalSpy finished(&compiler, &Compiler::compileFinished);
+    Heartbeat heartbeat;
+    heartbeat.start();
+    double firstMs = timeCall([&]()
+                              { compiler.compile(QString::fromUtf8(kStubbornSource), "test.c"); });
+    double secondMs = timeCall([&]()
+                               { compiler.compile(QString::fromUtf8(kHelloSource), "test.c"); });
+    QVERIFY(finished.count() > 0 || finished.wait(30000));
+    QTest::qWait(200); // 被取消的编译不应再报告
+    double stallMs = heartbeat.stop();
+
+    QCOMPARE(finished.count(), 1);
+    QVERIFY2(finished.first().at(0).toBool(), qPrintable(finished.first().at(1).toString()));
+    QVERIFY2(firstMs <= kMaxStallMs && secondMs <= kMaxStallMs,
+             qPrintable(QString("compile() %1 ms / %2 ms").arg(firstMs).arg(secondMs)));
+    QVERIFY2(stallMs <= kMaxStallMs, qPrintable(QString("最大停顿 %1 ms").arg(stallMs)));
+}
+
+// 停止忽略SIGTERM的程序：stopProgram立即返回，宽限期后由SIGKILL结束，期间事件循环不停顿
+void PipelineTest::stopIgnoringSigterm()
+{
+    Compiler compiler;
+    if (!compileSource(&compiler, kStubbornSource))
+        return;
+
+    QSignalSpy output(&compiler, &Compiler::runOutput);
+    QSignalSpy finished(&compiler, &Compiler::runFinished);
+    compiler.runProgram();
+    // 等程序打印ready，确认SIGTERM已被忽略
+    QTRY_VERIFY_WITH_TIMEOUT(!output.isEmpty(), 10000);
+
+    Heartbeat heartbeat;
+    heartbeat.start();
+    QElapsedTimer sinceStop;
+    sinceStop.start();
+    double callMs = timeCall([&]()
+                             { compiler.stopProgram(); });
+    QVERIFY(finished.wait(ProcessUtil::kTerminateGraceMs + 5000));
+    qint64 stoppedAfterMs = sinceStop.elapsed();
+    double stallMs = heartbeat.stop();
+
+    QVERIFY(!finished.first().at(0).toBool());
+    QVERIFY2(stoppedAfterMs >= ProcessUtil::kTerminateGraceMs - 50,
+             qPrintable(QString("程序在 %1 ms 后结束，SIGTERM未被忽略").arg(stoppedAfterMs)));
+    QVERIFY2(callMs <= kMaxStallMs, qPrintable(QString("stopProgram() %1 ms").arg(callMs)));
+    QVERIFY2(stallMs <= kMaxStallMs, qPrintable(QString("最大停顿 %1 ms").arg(stallMs)));
+}
+
+// 程序仍在运行时销毁Compiler：SIGKILL后回收，析构不等待宽限期
+void PipelineTest::destroyWhileRunning()
+{
+    Compiler *compiler = new Compiler;
+    if (!compileSource(compiler, kStubbornSource))
+    {
+        delete compiler;
+        return;
+    }
+
+    QSignalSpy output(compiler, &Compiler::runOutput);
+    compiler->runProgram();
+    QTRY_VERIFY_WITH_TIMEOUT(!output.isEmpty(), 10000);
+
+    double deleteMs = timeCall([&]()
+                               { delete compiler; });
+    QVERIFY2(deleteMs <= kMaxStallMs, qPrintable(QString("析构 %1 ms").arg(deleteMs)));
+}
+
+QTEST_GUILESS_MAIN(PipelineTest)
+
+#include "tst_pipeline.moc"
@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+
+# 测试和基准测试，与TinyIDE.pro分开构建：qmake tests/tests.pro && make && make check
+# 加上CONFIG+=tinyide_libtcc时同时检查libtcc内存编译运行的构建，并比较其与gcc静态链接的耗时
+SUBDIRS += \
+    benchmarks \
+    outputcollector \
+    pipeline
@@ -0,0 +1,266 @@
+#include "textsearch.h"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TEXTSEARCH_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // 传给查找内核的模式串描述
+    struct Needle
+    {
+        const ushort *chars;
+        int length;
+        bool folded;      // 是否按大小写折叠比较
+        ushort first;     // 首字符过滤值：候选字符先与firstMask按位或，再与其比较
+        ushort firstMask;
+        ushort last;      // 末字符过滤值
+        ushort lastMask;
+    };
+
+    // 计算单个字符的过滤条件
+    // 大小写不敏感时ASCII字母用0x20同时匹配大小写；其他可能由非ASCII字符折叠而来的字符
+    // （如U+212A折叠为k、U+017F折叠为s）用全1掩码使过滤总是通过，交给逐字符确认
+    void filterFor(ushort c, bool folded, ushort *value, ushort *mask)
+    {
+        bool asciiLetter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        if (!folded || (c < 128 && !asciiLetter))
+        {
+            *mask = 0;
+            *value = c;
+        }
+        else if (asciiLetter && c != 'k' && c != 's')
+        {
+            *mask = 0x20;
+            *value = c | 0x20;
+        }
+        else
+        {
+            *mask = 0xFFFF;
+            *value = 0xFFFF;
+        }
+    }
+
+    // 在候选位置逐字符确认匹配
+    inline bool matchAt(const ushort *data, const Needle &needle)
+    {
+        if (!needle.folded)
+            return std::memcmp(data, needle.chars, needle.length * sizeof(ushort)) == 0;
+
+        for (int i = 0; i < needle.length; ++i)
+        {
+            if (QChar::toCaseFolded(uint(data[i])) != needle.chars[i])
+                return false;
+        }
+        return true;
+    }
+
+    // 标量实现，也用于处理向量实现剩余的尾部
+    int findScalar(const ushort *data, int length, int from, const Needle &needle)
+    {
+        const int lastOffset = needle.length - 1;
+        for (int i = from; i + needle.length <= length; ++i)
+        {
+            if ((data[i] | needle.firstMask) == needle.first &&
+                (data[i + lastOffset] | needle.lastMask) == needle.last &&
+                matchAt(data + i, needle))
+                return i;
+        }
+        return -1;
+    }
+
+#ifdef TEXTSEARCH_X86_KERNELS
+    // SSE2实现：每次比较8个位置的首字符和末字符
+    __attribute__((target("sse2")))
+    int findSse2(const ushort *data, int length, int from, const Needle &needle)
+    {
+        const int lastOffset = needle.length - 1;
+        const __m128i first = _mm_set1_epi16(short(needle.first));
+        const __m128i firstMask = _mm_set1_epi16(short(needle.firstMask));
+        const __m128i last = _mm_set1_epi16(short(needle.last));
+        const __m128i lastMask = _mm_set1_epi16(short(needle.lastMask));
+
+        int i = from;
+        for (; i + lastOffset + 8 <= length; i += 8)
+        {
+            __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + lastOffset));
+            __m128i hit = _mm_and_si128(_mm_cmpeq_epi16(_mm_or_si128(head, firstMask), first),
+                                        _mm_cmpeq_epi16(_mm_or_si128(tail, lastMask), last));
+
+            // 每个16位通道在掩码中占两位，只保留低位
+            uint bits = uint(_mm_movemask_epi8(hit)) & 0x5555u;
+            while (bits)
+            {
+                int lane = __builtin_ctz(bits) / 2;
+                if (matchAt(data + i + lane, needle))
+                    return i + lane;
+                bits &= bits - 1;
+            }
+        }
+        return findScalar(data, length, i, needle);
+    }
+
+    // AVX2实现：每次比较16个位置
+    __attribute__((target("avx2")))
+    int findAvx2(const ushort *data, int length, int from, const Needle &needle)
+    {
+        const int lastOffset = needle.length - 1;
+        const __m256i first = _mm256_set1_epi16(short(needle.first));
+        const __m256i firstMask = _mm256_set1_epi16(short(needle.firstMask));
+        const __m256i last = _mm256_set1_epi16(short(needle.last));
+        const __m256i lastMask = _mm256_set1_epi16(short(needle.lastMask));
+
+        int i = from;
+        for (; i + lastOffset + 16 <= length; i += 16)
+        {
+            __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + lastOffset));
+            __m256i hit = _mm256_and_si256(_mm256_cmpeq_epi16(_mm256_or_si256(head, firstMask), first),
+                                           _mm256_cmpeq_epi16(_mm256_or_si256(tail, lastMask), last));
+
+            uint bits = uint(_mm256_movemask_epi8(hit)) & 0x55555555u;
+            while (bits)
+            {
+                int lane = __builtin_ctz(bits) / 2;
+                if (matchAt(data + i + lane, needle))
+                    return i + lane;
+                bits &= bits - 1;
+            }
+        }
+        return findScalar(data, length, i, needle);
+    }
+#endif
+
+    typedef int (*FindKernel)(const ushort *data, int length, int from, const Needle &needle);
+
+    struct Kernel
+    {
+        FindKernel find;
+        const char *name;
+    };
+
+    // 当前CPU支持的实现，按优先顺序排列
+    QVector<Kernel> supportedKernels()
+    {
+        QVector<Kernel> kernels;
+#ifdef TEXTSEARCH_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            kernels.append({findAvx2, "avx2"});
+        if (__builtin_cpu_supports("sse2"))
+            kernels.append({findSse2, "sse2"});
+#endif
+        kernels.append({findScalar, "scalar"});
+        return kernels;
+    }
+
+    Kernel &kernel()
+    {
+        static Kernel selected = supportedKernels().first();
+        return selected;
+    }
+
+    inline bool isWordChar(QChar c)
+    {
+        return c.isLetterOrNumber() || c == QLatin1Char('_');
+    }
+}
+
+TextSearch::TextSearch(const QString &pattern, Options options)
+    : m_pattern(pattern),
+      m_needle(options & CaseInsensitive ? pattern.toCaseFolded() : pattern),
+      m_options(options)
+{
+}
+
+QString TextSearch::pattern() const
+{
+    return m_pattern;
+}
+
+TextSearch::Options TextSearch::options() const
+{
+    return m_options;
+}
+
+// 在[from, end)内查找第一个匹配，全字匹配不成立时从下一个位置继续
+int TextSearch::indexIn(const QChar *data, int length, int from, int end) const
+{
+    const int n = m_needle.length();
+    if (end < 0 || end > length)
+        end = length;
+    from = qMax(from, 0);
+    if (n == 0)
+        return -1;
+
+    Needle needle;
+    needle.chars = reinterpret_cast<const ushort *>(m_needle.constData());
+    needle.length = n;
+    needle.folded = (m_options & CaseInsensitive) != 0;
+    filterFor(needle.chars[0], needle.folded, &needle.first, &needle.firstMask);
+    filterFor(needle.chars[n - 1], needle.folded, &needle.last, &needle.lastMask);
+
+    const ushort *chars = reinterpret_cast<const ushort *>(data);
+    const FindKernel find = kernel().find;
+    while (from + n <= end)
+    {
+        int pos = find(chars, end, from, needle);
+        if (pos < 0)
+            return -1;
+        if (!(m_options & WholeWord) || isWholeWordAt(data, length, pos))
+            return pos;
+        from = pos + 1;
+    }
+    return -1;
+}
+
+int TextSearch::indexIn(const QString &text, int from) const
+{
+    return indexIn(text.constData(), text.length(), from);
+}
+
+// 查找所有互不重叠的匹配
+QVector<int> TextSearch::findAll(const QString &text) const
+{
+    QVector<int> positions;
+    const int n = qMax(1, m_needle.length());
+    for (int pos = indexIn(text, 0); pos != -1; pos = indexIn(text, pos + n))
+        positions.append(pos);
+    return positions;
+}
+
+const char *TextSearch::kernelName()
+{
+    return kernel().name;
+}
+
+QStringList TextSearch::availableKernels()
+{
+    QStringList names;
+    for (const Kernel &candidate : supportedKernels())
+        names << QString::fromLatin1(candidate.name);
+    return names;
+}
+
+bool TextSearch::setKernel(const QString &name)
+{
+    for (const Kernel &candidate : supportedKernels())
+    {
+        if (name == QLatin1String(candidate.name))
+        {
+            kernel() = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 判断匹配两侧是否为单词边界
+bool TextSearch::isWholeWordAt(const QChar *data, int length, int pos) const
+{
+    int end = pos + m_needle.length();
+    return (pos == 0 || !isWordChar(data[pos - 1])) && (end >= length || !isWordChar(data[end]));
+}
@@ -0,0 +1,52 @@
+#ifndef TEXTSEARCH_H
+#define TEXTSEARCH_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QFlags>
+
+// 字面量子串查找：用SSE2/AVX2按首尾字符批量过滤候选位置，再逐字符确认
+// 运行时按CPU支持情况选择实现，不支持时退回标量版本
+// 编辑器查找/替换、输出窗口和多文件搜索共用同一个查找内核
+class TextSearch
+{
+public:
+    enum Option
+    {
+        NoOptions = 0,
+        CaseInsensitive = 1, // 按Unicode大小写折叠比较
+        WholeWord = 2        // 匹配两侧不能是字母、数字或下划线
+    };
+    Q_DECLARE_FLAGS(Options, Option)
+
+    explicit TextSearch(const QString &pattern = QString(), Options options = NoOptions);
+
+    QString pattern() const;
+    Options options() const;
+
+    // 在data的[from, end)内查找第一个完整落在该区间的匹配，end为-1表示到length为止
+    // 全字匹配时会参考区间外侧的字符判断单词边界
+    int indexIn(const QChar *data, int length, int from = 0, int end = -1) const;
+    int indexIn(const QString &text, int from = 0) const;
+    // 查找所有互不重叠的匹配，返回升序的起始位置
+    QVector<int> findAll(const QString &text) const;
+
+    // 当前CPU上使用的实现（"avx2"、"sse2"或"scalar"）
+    static const char *kernelName();
+    // 当前CPU支持的实现，第一个为默认选择
+    static QStringList availableKernels();
+    // 改用指定的实现，供基准测试比较各实现；不支持时返回false。不能与正在进行的查找同时调用
+    static bool setKernel(const QString &name);
+
+private:
+    bool isWholeWordAt(const QChar *data, int length, int pos) const;
+
+    QString m_pattern;
+    QString m_needle; // 实际比较的模式串，大小写不敏感时为折叠后的形式
+    Options m_options;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(TextSearch::Options)
+
+#endif // TEXTSEARCH_H